@@ -31,29 +31,208 @@
 // CONSTANTS
 //////////////////////////////////////////////////////////////////////////
 
-/** Clock frequency in Hz. Used by the Delay.h AVR library. */
-# define F_CPU 1000000UL
+/** Clock frequency in Hz. Used by the Delay.h AVR library. Can be overridden with -DF_CPU. */
+#ifndef F_CPU
+#define F_CPU 1000000UL
+#endif
 
-/** Timer1 compare interrupt value. Used to create an interrupt every second. */
-#define TIMER1_CMP			15624	// Timer1 = 1 sec
+/** Profiling of interrupts and drawing (see hw/Profile.h), 1 to build it in. Can be overridden with -DPROFILE=1. */
+#ifndef PROFILE
+#define PROFILE 0
+#endif
+
+/** Trace pins for a logic analyser (see hw/Trace.h), 1 to build them in. Can be overridden with -DTRACE=1. */
+#ifndef TRACE
+#define TRACE 0
+#endif
+
+/** Display controllers (see hw/DisplayControllers.h). */
+#define DISPLAY_ST7920		1
+#define DISPLAY_ST7565		2
+#define DISPLAY_SSD1306		3
+
+/** Display controller of the board. Can be overridden with -DDISPLAY_CONTROLLER=DISPLAY_SSD1306. */
+#ifndef DISPLAY_CONTROLLER
+#define DISPLAY_CONTROLLER DISPLAY_ST7920
+#endif
+
+/** Links to the display controller (see hw/Display.h). */
+#define DISPLAY_LINK_SPI	1
+#define DISPLAY_LINK_USART	2
+
+/**
+ * Link to the display controller: the hardware SPI, or the USART in master SPI mode, fed by its
+ * interrupts (see hw/DisplayUsart.h). The USART link takes the serial console and the time bus,
+ * and moves the UP button off XCK. Can be overridden with -DDISPLAY_LINK=DISPLAY_LINK_USART.
+ */
+#ifndef DISPLAY_LINK
+#define DISPLAY_LINK DISPLAY_LINK_SPI
+#endif
+
+/**
+ * Band pipeline of the display (see DisplayUsartPipeline in hw/DisplayUsart.h), 1 to build it in:
+ * page controllers on the USART link only. Can be overridden with -DDISPLAY_PIPELINE=1.
+ */
+#ifndef DISPLAY_PIPELINE
+#define DISPLAY_PIPELINE 0
+#endif
+
+/** Timer1 compare interrupt frequency in Hz. Used to count seconds. */
+#define TIMER1_HZ			1
 
-/** Timer2 compare interrupt value. Used to create an 3kHz buzz. */
-#define TIMER2_CMP			11		// Timer2 = 3Khz
+/** Largest acceptable Timer1 frequency error in ppm (50 ppm = 4.3 sec/day). */
+#define TIMER1_MAX_PPM		50
+
+/** Buzzer tone frequency in Hz. Timer2 interrupts twice per period. */
+#define BUZZER_HZ			3000
+
+/** Largest acceptable buzzer tone error in ppm. */
+#define TIMER2_MAX_PPM		20000
+
+/** Shortest acceptable Timer0 overflow period in microseconds. */
+#define TIMER0_PERIOD_US	2000
 
 /** Debounce check delay in milliseconds. */
 #define DELAY_DEBOUNCE		10		// ms
 
+/** Duration of a long press in milliseconds. */
+#define PERIOD_LONG_PRESS	2000	// ms
+
+/** Backlight timeout in milliseconds. */
+#define PERIOD_BACKLIGHT	5000	// ms
+
+/** Duration of a single ringing "beep" in milliseconds. */
+#define PERIOD_BUZZER_LONG	1000	// ms
+
+/** Duration of a single button "beep" in milliseconds. */
+#define PERIOD_BUZZER_SHORT	250		// ms
+
+#include "timers.h"
+
+/** Timer1 compare interrupt value. Used to create an interrupt every second. */
+#define TIMER1_CMP			(TIMER1_CFG.top)
+
+/** Timer2 compare interrupt value. Used to create the buzzer tone. */
+#define TIMER2_CMP			(TIMER2_CFG.top)
+
 /** Number of Timer0 interrupts that amounts to a long press event. */
-#define N_LONG_PRESS		976	    // Timer0 = 2 sec
+#define N_LONG_PRESS		TIMER0_COUNT(PERIOD_LONG_PRESS)
 
 /** Number of Timer0 interrupts that amounts to the backlight timeout. */
-#define N_BACKLIGHT			2441 	// Timer0 = 5 sec
+#define N_BACKLIGHT			TIMER0_COUNT(PERIOD_BACKLIGHT)
 
 /** Number of Timer0 interrupts that amounts to a single ringing "beep". */
-#define N_BUZZER_LONG		448 	// Timer0 = 1 sec
+#define N_BUZZER_LONG		TIMER0_COUNT(PERIOD_BUZZER_LONG)
 
 /** Number of Timer0 interrupts that amounts to a single button "beep". */
-#define N_BUZZER_SHORT		112 	// Timer0 = 25 msec
+#define N_BUZZER_SHORT		TIMER0_COUNT(PERIOD_BUZZER_SHORT)
+
+//////////////////////////////////////////////////////////////////////////
+// EEPROM
+//////////////////////////////////////////////////////////////////////////
+
+/** Address of the settings slot ring. */
+#define EEPROM_SETTINGS		0
+
+/**
+ * Number of settings slots. Each cell is rewritten once every SETTINGS_SLOTS saves: at a
+ * typical 3 saves a day, 100k cycles last 8 * 100000 / 3 days, more than 700 years.
+ */
+#define SETTINGS_SLOTS		8
+
+/** Seconds the settings must stay unchanged before being saved. */
+#define SETTINGS_DELAY		5
+
+/** Address of the clock checkpoint slot ring. */
+#define EEPROM_CHECKPOINT	64
+
+/**
+ * Number of clock checkpoint slots. At one checkpoint every 10 minutes each cell is rewritten
+ * 144 / 32 = 4.5 times a day: 100k cycles last about 60 years.
+ */
+#define CHECKPOINT_SLOTS	32
+
+/** Seconds between two clock checkpoints. */
+#define CHECKPOINT_PERIOD	600
+
+/** Address of the event log ring buffer. */
+#define EEPROM_LOG			256
+
+/** Size of the event log ring buffer in bytes, 2 bytes per record: 384 records. */
+#define EEPROM_LOG_SIZE		768
+
+/** Largest number of records waiting in RAM to be written. */
+#define LOG_BATCH			8
+
+/** Minutes after which records waiting in RAM are written, even if less than a block. */
+#define LOG_FLUSH_PERIOD	60
+
+//////////////////////////////////////////////////////////////////////////
+// SERIAL
+//////////////////////////////////////////////////////////////////////////
+
+/** Serial console baud rate. */
+#define UART_BAUD			9600
+
+/** Receive ring buffer size in bytes, power of 2. */
+#define UART_RX_BUFFER		32
+
+/** Transmit ring buffer size in bytes, power of 2. */
+#define UART_TX_BUFFER		64
+
+/** Longest console command line, in characters. */
+#define CONSOLE_LINE		24
+
+/** Seconds between two telemetry frames. */
+#define TELEMETRY_PERIOD	1
+
+/** Largest number of bytes of a telemetry frame encoded at each main loop pass. */
+#define TELEMETRY_STEP		8
+
+//////////////////////////////////////////////////////////////////////////
+// TIME SYNCHRONISATION
+//////////////////////////////////////////////////////////////////////////
+
+/** Seconds between two time requests to the host. */
+#define SYNC_PERIOD			64
+
+/** Seconds to wait for the host response. */
+#define SYNC_TIMEOUT		2
+
+/** Largest slew, in parts per million of a second: 5000 ppm corrects 5 ms each second. */
+#define SYNC_SLEW_PPM		5000
+
+/** Offsets larger than this are stepped instead of slewed, in ms. */
+#define SYNC_STEP_MS		2000
+
+/** Exchanges with a longer round trip are discarded, in ms. */
+#define SYNC_DELAY_MAX		100
+
+/** Second of each minute at which the bus master sends its time beacon. */
+#define BUS_SECOND			30
+
+//////////////////////////////////////////////////////////////////////////
+// DISPLAY
+//////////////////////////////////////////////////////////////////////////
+
+/** USART link of the display: UBRR0, a byte every 16 * (DISPLAY_USART_UBRR + 1) cycles. */
+#define DISPLAY_USART_UBRR	3
+
+/** USART link of the display: queued bytes, power of 2. */
+#define DISPLAY_USART_BUFFER	16
+
+/** USART link of the display: bytes of each of the two band slots, whole 8x8 blocks of 8 bytes. */
+#define DISPLAY_BAND		32
+
+//////////////////////////////////////////////////////////////////////////
+// DIAGNOSTICS
+//////////////////////////////////////////////////////////////////////////
+
+/** Smallest acceptable stack headroom in bytes, free RAM left above .bss at the deepest stack use. */
+#define STACK_MIN_HEADROOM	64
+
+/** Largest number of painted bytes stack_scan() checks at each main loop pass. */
+#define STACK_SCAN_STEP		16
 
 //////////////////////////////////////////////////////////////////////////
 // PINOUT
@@ -64,26 +243,47 @@
 #define PORT_BUZZER			B
 #define LINE_BUZZER			1
 
-#define PORT_BTN_SET_CLOCK	D
+#define PORT_BTN_SET_CLOCK	C
 #define LINE_BTN_SET_CLOCK	1
 #define PORT_BTN_SET_ALARM	D
 #define LINE_BTN_SET_ALARM	2
 #define PORT_BTN_STOP_ALARM	D
 #define LINE_BTN_STOP_ALARM	3
+#if DISPLAY_LINK == DISPLAY_LINK_USART
+// PD4 is XCK, the display clock: UP moves to PB2, free without the SPI
+#define PORT_BTN_UP			B
+#define LINE_BTN_UP			2
+#else
 #define PORT_BTN_UP			D
 #define LINE_BTN_UP			4
+#endif
 #define PORT_BTN_DOWN		D
 #define LINE_BTN_DOWN		5
 #define PORT_BTN_MODE		D
 #define LINE_BTN_MODE		6
 #define PORT_BTN_SNOOZE		D
 #define LINE_BTN_SNOOZE		7
-#define PORT_SWITCH			D	
+#define PORT_SWITCH			C
 #define LINE_SWITCH			0
 
 #define PORT_DISPLAY_A0		B
 #define LINE_DISPLAY_A0		0
-#define PORT_DISPLAY_RESET	D
-#define LINE_DISPLAY_RESET	0
+#define PORT_DISPLAY_RESET	C
+#define LINE_DISPLAY_RESET	2
+
+// PD0 and PD1 are RXD and TXD of the USART (serial console). With the USART link of the display,
+// TXD is the display data and PD4 (XCK) its clock.
+
+/** Driver enable of the RS-485 transceiver of the time bus, high while the master sends a beacon. */
+#define PORT_BUS_DE			C
+#define LINE_BUS_DE			3
+
+/** Trace pins, only driven with TRACE set. PB6 and PB7 are free with the internal oscillator. */
+#define PORT_TRACE_ISR		C
+#define LINE_TRACE_ISR		4
+#define PORT_TRACE_FRAME	B
+#define LINE_TRACE_FRAME	6
+#define PORT_TRACE_UPDATE	B
+#define LINE_TRACE_UPDATE	7
 
 #endif /* CONSTANTS_H_ */
\ No newline at end of file
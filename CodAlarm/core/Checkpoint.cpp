@@ -0,0 +1,69 @@
+#include "Checkpoint.h"
+#include "Settings.h"
+
+#include <util/atomic.h>
+
+static_assert(sizeof(t_checkpoint) <= SLOT_PAYLOAD_MAX, "Checkpoint: record too large for a slot");
+static_assert(EEPROM_CHECKPOINT >= EEPROM_SETTINGS + SlotRing::footprint(SETTINGS_SLOTS, sizeof(t_settings)),
+		"Checkpoint: slots overlap settings");
+
+Checkpoint::Checkpoint(CodAlarm* _ca) :
+	ring(&_ca->eeprom, EEPROM_CHECKPOINT, CHECKPOINT_SLOTS, sizeof(t_checkpoint)) {
+	
+	ca = _ca;
+	countdown = CHECKPOINT_PERIOD;
+	reset_cause = 0;
+}
+
+bool Checkpoint::restore(uint8_t _reset_cause){
+	t_checkpoint checkpoint;
+	
+	reset_cause = _reset_cause;
+	
+	if(!ring.load(&checkpoint))
+		return false;	// Never saved: start from midnight
+	
+	long value = checkpoint.time[0] | ((long) checkpoint.time[1] << 8) | ((long) checkpoint.time[2] << 16);
+	if(value >= D_SEC)
+		return false;
+	
+	// Time elapsed while off is unknown
+	ca->clock.setValue(value);
+	ca->stale = true;
+	return true;
+}
+
+void Checkpoint::request(){
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		countdown = 0;
+	}
+}
+
+void Checkpoint::tick(){
+	if(countdown > 0)
+		countdown--;
+}
+
+void Checkpoint::poll(){
+	long value;
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		if(countdown > 0)
+			return;
+		
+		value = ca->clock.getValue();
+	}
+	
+	t_checkpoint checkpoint;
+	checkpoint.time[0] = value;
+	checkpoint.time[1] = value >> 8;
+	checkpoint.time[2] = value >> 16;
+	
+	// EEPROM busy (settings): retry at next call
+	if(ring.save(&checkpoint))
+		countdown = CHECKPOINT_PERIOD;
+}
+
+uint8_t Checkpoint::getResetCause(){
+	return reset_cause;
+}
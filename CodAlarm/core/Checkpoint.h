@@ -0,0 +1,80 @@
+#ifndef CHECKPOINT_H_
+#define CHECKPOINT_H_
+
+#include <stdint.h>
+
+#include "../constants.h"
+#include "CodAlarm.h"
+#include "SlotRing.h"
+
+/** Clock checkpoint saved in EEPROM: seconds from midnight, 24-bit little endian. */
+struct t_checkpoint {
+	uint8_t time[3];
+};
+
+/**
+ * \brief Saves the clock periodically in EEPROM, to restore it after a power loss.
+ * A checkpoint is taken every CHECKPOINT_PERIOD seconds, and as soon as possible after the clock
+ * is set. Saving only starts a background EEPROM write, so it can run from the main loop without
+ * delaying the Timer1 tick. At boot the time of the last checkpoint is restored and flagged as
+ * stale until the user or a time source sets the clock again.
+ *
+ * Brown-out detection must be enabled in the fuses (BODLEVEL = 2.7 V): a supply dip then resets
+ * the MCU cleanly instead of corrupting the EEPROM write in progress, and sets BORF in MCUSR.
+ */
+class Checkpoint {
+
+public:
+	/**
+	 * Class constructor.
+	 * \param ca Pointer to CodAlarm Object instance.
+	 * \return
+	 */
+	Checkpoint(CodAlarm*);
+	
+	/**
+	 * Restores the clock from the last checkpoint and flags it as stale.
+	 * \param reset_cause MCUSR value at boot
+	 * \return bool true if a checkpoint was found
+	 */
+	bool restore(uint8_t);
+	
+	/**
+	 * Requests a checkpoint as soon as possible, e.g. after the clock has been set.
+	 * \return void
+	 */
+	void request();
+	
+	/**
+	 * Counts the time to the next checkpoint. Must be called every second (Timer1 interrupt).
+	 * \return void
+	 */
+	void tick();
+	
+	/**
+	 * Saves a checkpoint when due. Must be called from the main loop.
+	 * \return void
+	 */
+	void poll();
+	
+	/**
+	 * Returns the reset cause passed to restore().
+	 * \return MCUSR flags (PORF, EXTRF, BORF, WDRF)
+	 */
+	uint8_t getResetCause();
+
+private:
+	/** Pointer the instance of CodAlarm passed in the constructor */
+	CodAlarm* ca;
+	
+	/** Slots in EEPROM. */
+	SlotRing ring;
+	
+	/** Seconds to the next checkpoint, 0 if due. */
+	volatile uint16_t countdown;
+	
+	/** MCUSR value at boot. */
+	uint8_t reset_cause;
+};
+
+#endif /* CHECKPOINT_H_ */
@@ -13,8 +13,8 @@ void Clock::_add(int val){
 	
 	// count is circular from 0 to DAY_SEC
 	if(count < 0){
-		count = D_SEC - count;
-	}else if(count > D_SEC){
+		count = D_SEC + count;
+	}else if(count >= D_SEC){
 		count = count - D_SEC;
 	}		
 }
@@ -27,6 +27,10 @@ long Clock::getValue(){
 	return count;
 }
 
+void Clock::setValue(long value){
+	count = value;
+}
+
 void Clock::sync(Clock source){
 	count = source.getValue();
 }
@@ -43,17 +47,17 @@ int Clock::getHour(t_mode mode){
 	int x = count/H_SEC;
 	
 	if(mode == H12)
-		return x > 12 ? x-11 : x;
+		return x % 12 == 0 ? 12 : x % 12;
 	else
 		return x;
 }
 
 int Clock::getMin(){
-	return count%H_SEC;
+	return (count%H_SEC)/M_SEC;
 }
 
 bool Clock::isAm(){
 	int x = count/H_SEC;
 	
-	return x > 12 ? true : false;
+	return x < 12 ? true : false;
 }
\ No newline at end of file
@@ -4,7 +4,7 @@
 #define CLOCK_H_
 
 /** Number of seconds in a day. */
-#define D_SEC 3600*24
+#define D_SEC (3600L*24)
 
 /** Number of seconds in an hour. */
 #define H_SEC 3600
@@ -61,6 +61,13 @@ public:
      */
     long getValue();
 
+    /**
+     * Sets the clock value in seconds.
+     * \param value seconds, from 0 to D_SEC - 1
+     * \return void
+     */
+    void setValue(long);
+
     /**
      * Sets time to the value of another clock.
      * \param source source clock
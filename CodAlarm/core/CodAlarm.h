@@ -3,7 +3,15 @@
 
 #include "Clock.h"
 #include "../hw/Display.h"
+#include "../hw/Eeprom.h"
 #include "../hw/IO.h"
+#include "../hw/Uart.h"
+
+/** Number of states in t_state. */
+#define N_STATES	6
+
+/** Number of events in t_event. */
+#define N_EVENTS	10
 
 /**
  * Alarm clock state type.
@@ -11,9 +19,9 @@
 enum t_state { 
 	/** System is idling. */
 	IDLE, 
-	/** Setting clock minutes */
-	SET_CLOCK1, 
 	/** Setting clock hours */
+	SET_CLOCK1, 
+	/** Setting clock minutes */
 	SET_CLOCK2, 
 	/** Setting alarm hours */
 	SET_ALARM1,
@@ -23,6 +31,44 @@ enum t_state {
 	RING 
 };
 
+/**
+ * Events driving the state machine.
+ */
+enum t_event {
+	/** "Set Alarm" short press */
+	EV_SET_ALARM,
+	/** "Set Alarm" long press */
+	EV_SET_ALARM_LONG,
+	/** "Set Clock" short press */
+	EV_SET_CLOCK,
+	/** "Set Clock" long press */
+	EV_SET_CLOCK_LONG,
+	/** "Stop Alarm" short press */
+	EV_STOP_ALARM,
+	/** "Up" short press */
+	EV_UP,
+	/** "Down" short press */
+	EV_DOWN,
+	/** "Snooze" short press */
+	EV_SNOOZE,
+	/** Switch set on "Alarm off", sent as long as it stays there */
+	EV_SWITCH_OFF,
+	/** Clock reached the alarm or snooze time */
+	EV_ALARM
+};
+
+/**
+ * Role on the time bus.
+ */
+enum t_bus {
+	/** Not on a bus. */
+	BUS_OFF,
+	/** Sends time beacons. */
+	BUS_MASTER,
+	/** Follows the beacons of the master. */
+	BUS_SLAVE
+};
+
 /**
  * Wrapper class for the system configuration, state and time.
  */
@@ -35,6 +81,8 @@ class CodAlarm
 		state = IDLE;
 		mode = H24;
 		snoozed = false; 
+		stale = false;
+		bus = BUS_OFF;
 	}
 	
 	//////////////////////////////////////////////////////////////////////////
@@ -47,6 +95,12 @@ class CodAlarm
 	/** IO wapper instance. */
 	IO io;
 	
+	/** EEPROM wrapper instance. */
+	Eeprom eeprom;
+	
+	/** Serial port wrapper instance. */
+	Uart uart;
+	
 	//////////////////////////////////////////////////////////////////////////
 	// CLOCKS
 	//////////////////////////////////////////////////////////////////////////
@@ -72,6 +126,12 @@ class CodAlarm
 	
 	/** True if the Alarm has been snoozed during last ring state. */
 	bool snoozed;
+	
+	/** True if the clock was restored after a power loss and may be late. */
+	bool stale;
+	
+	/** Role on the time bus. */
+	t_bus bus;
 };
 
 
@@ -0,0 +1,169 @@
+#include "Command.h"
+
+#include <avr/pgmspace.h>
+#include <string.h>
+
+/** Keyword of a command. */
+struct t_keyword {
+	char name[10];
+	uint8_t id;
+};
+
+/** Keywords, stored in flash. */
+static const t_keyword KEYWORDS[] PROGMEM = {
+	{ "help",      CMD_HELP },
+	{ "time",      CMD_TIME },
+	{ "alarm",     CMD_ALARM },
+	{ "mode",      CMD_MODE },
+	{ "state",     CMD_STATE },
+	{ "stats",     CMD_STATS },
+	{ "log",       CMD_LOG },
+	{ "telemetry", CMD_TELEMETRY },
+	{ "sync",      CMD_SYNC },
+	{ "bus",       CMD_BUS },
+	{ "prof",      CMD_PROF },
+	{ "mem",       CMD_MEM },
+};
+
+#define N_KEYWORDS	(sizeof(KEYWORDS) / sizeof(KEYWORDS[0]))
+
+/**
+ * Reads a 2 digit number.
+ * \param s position, advanced past the digits
+ * \param max largest accepted value
+ * \param value destination
+ * \return bool false if not 1 or 2 digits, or above max
+ */
+static bool _number(const char** s, uint8_t max, uint8_t* value) {
+	uint8_t n = 0;
+	uint8_t x = 0;
+
+	while(**s >= '0' && **s <= '9') {
+		if(++n > 2)
+			return false;
+		x = x * 10 + (**s - '0');
+		(*s)++;
+	}
+
+	*value = x;
+	return n > 0 && x <= max;
+}
+
+/**
+ * Reads a time, HH:MM or HH:MM:SS.
+ * \param s value, null terminated
+ * \param cmd destination of hours, minutes and seconds
+ * \param with_seconds true if seconds are accepted
+ * \return bool false if invalid
+ */
+static bool _time(const char* s, t_command* cmd, bool with_seconds) {
+	if(!_number(&s, 23, &cmd->hours) || *s++ != ':' || !_number(&s, 59, &cmd->minutes))
+		return false;
+
+	if(*s == ':' && with_seconds) {
+		s++;
+		if(!_number(&s, 59, &cmd->seconds))
+			return false;
+	}
+
+	return *s == '\0';
+}
+
+/**
+ * Checks the value of a command.
+ * \param value value, null terminated, can be empty
+ * \param cmd command, id already set
+ * \return bool false if invalid
+ */
+static bool _value(const char* value, t_command* cmd) {
+	cmd->set = *value != '\0';
+	if(!cmd->set)
+		return true;
+
+	switch(cmd->id) {
+	case CMD_TIME:
+		return _time(value, cmd, true);
+
+	case CMD_ALARM:
+		return _time(value, cmd, false);
+
+	case CMD_MODE:
+		return _number(&value, 24, &cmd->hours) && *value == '\0'
+				&& (cmd->hours == 12 || cmd->hours == 24);
+
+	case CMD_TELEMETRY:
+	case CMD_SYNC:
+		cmd->hours = strcmp_P(value, PSTR("on")) == 0;
+		return cmd->hours || strcmp_P(value, PSTR("off")) == 0;
+
+	case CMD_BUS:
+		if(strcmp_P(value, PSTR("master")) == 0)
+			cmd->hours = 1;
+		else if(strcmp_P(value, PSTR("slave")) == 0)
+			cmd->hours = 2;
+		else
+			return strcmp_P(value, PSTR("off")) == 0;
+		return true;
+
+	default:
+		// No value accepted
+		return false;
+	}
+}
+
+t_command_id command_parse(const char* line, t_command* cmd) {
+	char word[sizeof(KEYWORDS[0].name)];
+	char value[12];
+	uint8_t n;
+
+	cmd->id = CMD_EMPTY;
+	cmd->set = false;
+	cmd->hours = 0;
+	cmd->minutes = 0;
+	cmd->seconds = 0;
+
+	while(*line == ' ')
+		line++;
+	if(*line == '\0')
+		return CMD_EMPTY;
+
+	// Keyword
+	cmd->id = CMD_UNKNOWN;
+	for(n = 0; *line != ' ' && *line != '\0'; line++) {
+		if(n == sizeof(word) - 1)
+			return CMD_UNKNOWN;
+		word[n++] = *line;
+	}
+	word[n] = '\0';
+
+	for(uint8_t i = 0; i < N_KEYWORDS; i++) {
+		if(strcmp_P(word, KEYWORDS[i].name) == 0) {
+			cmd->id = pgm_read_byte(&KEYWORDS[i].id);
+			break;
+		}
+	}
+	if(cmd->id == CMD_UNKNOWN)
+		return CMD_UNKNOWN;
+
+	// Value, trailing spaces removed
+	while(*line == ' ')
+		line++;
+	for(n = 0; *line != ' ' && *line != '\0'; line++) {
+		if(n == sizeof(value) - 1)
+			break;
+		value[n++] = *line;
+	}
+	value[n] = '\0';
+	while(*line == ' ')
+		line++;
+
+	if(*line != '\0') {
+		// Value too long, or more than one
+		cmd->set = true;
+		cmd->id = CMD_INVALID;
+	} else if(!_value(value, cmd)) {
+		cmd->id = CMD_INVALID;
+	}
+
+	return (t_command_id) cmd->id;
+}
@@ -0,0 +1,73 @@
+/*! \file */
+
+#ifndef COMMAND_H_
+#define COMMAND_H_
+
+#include <stdint.h>
+
+/**
+ * Console commands. Lines are a keyword followed by an optional value:
+ *
+ *     help
+ *     time [HH:MM[:SS]]
+ *     alarm [HH:MM]
+ *     mode [12|24]
+ *     state
+ *     stats
+ *     log
+ *     telemetry [on|off]
+ *     sync [on|off]
+ *     bus [off|master|slave]
+ *     prof
+ *     mem
+ *
+ * Without a value time, alarm, mode, telemetry, sync and bus are read, with a value they are set.
+ */
+enum t_command_id {
+	/** Empty line, ignored. */
+	CMD_EMPTY,
+	/** Unknown keyword. */
+	CMD_UNKNOWN,
+	/** Known keyword, invalid value. */
+	CMD_INVALID,
+	CMD_HELP,
+	CMD_TIME,
+	CMD_ALARM,
+	CMD_MODE,
+	CMD_STATE,
+	CMD_STATS,
+	CMD_LOG,
+	CMD_TELEMETRY,
+	CMD_SYNC,
+	CMD_BUS,
+	CMD_PROF,
+	CMD_MEM
+};
+
+/** Parsed console command. */
+struct t_command {
+	/** Command (t_command_id). */
+	uint8_t id;
+	/** True if a value was given. */
+	bool set;
+	/**
+	 * Hours, minutes and seconds for time and alarm. Hours also holds 12 or 24 for mode, and
+	 * 1 (on) or 0 (off) for telemetry and sync, and the t_bus role (0 off, 1 master, 2 slave)
+	 * for bus.
+	 */
+	uint8_t hours;
+	uint8_t minutes;
+	uint8_t seconds;
+};
+
+/**
+ * \brief Parses a console command line.
+ * Doesn't depend on the hardware, so it can also be built on the host (see tools/cmdparse).
+ * Spaces around the keyword and the value are ignored.
+ * \param line null terminated line, without line terminator
+ * \param cmd parsed command
+ * \return command id, also stored in cmd
+ */
+t_command_id command_parse(const char*, t_command*);
+
+#endif /* COMMAND_H_ */
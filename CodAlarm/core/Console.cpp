@@ -0,0 +1,336 @@
+#include "Console.h"
+
+#include <avr/pgmspace.h>
+#include <util/atomic.h>
+
+/** Free space needed in the transmit buffer to run a line: longest reply (stats). */
+#define CONSOLE_REPLY	56
+
+/** Free space needed in the transmit buffer to send a line of the profile: latency histogram. */
+#define CONSOLE_PROBE	60
+
+/** Lines of the profile: durations, then latencies. */
+#define CONSOLE_PROFILE_LINES	(N_PROBES + N_LATENCIES)
+
+static_assert(CONSOLE_REPLY < UART_TX_BUFFER && CONSOLE_PROBE < UART_TX_BUFFER,
+		"Console: UART_TX_BUFFER too small for the replies");
+
+/** Bus roles, in the order of t_bus. */
+static const char BUS_NAMES[3][7] PROGMEM = {
+	"off", "master", "slave"
+};
+
+/** State names, in the order of t_state. */
+static const char STATE_NAMES[N_STATES][11] PROGMEM = {
+	"IDLE", "SET_CLOCK1", "SET_CLOCK2", "SET_ALARM1", "SET_ALARM2", "RING"
+};
+
+Console::Console(CodAlarm* _ca, Checkpoint* _checkpoint, EventLog* _eventlog, Telemetry* _telemetry,
+		TimeSync* _timesync){
+	ca = _ca;
+	checkpoint = _checkpoint;
+	eventlog = _eventlog;
+	telemetry = _telemetry;
+	timesync = _timesync;
+	length = 0;
+	overflow = false;
+	ready = false;
+	frame_length = 0;
+	in_frame = false;
+	dump = LOG_DUMP_END;
+	probe = CONSOLE_PROFILE_LINES;
+}
+
+void Console::poll(){
+	// Log dump in progress: continue it before anything else
+	if(dump != LOG_DUMP_END){
+		dump = eventlog->dump(&ca->uart, dump);
+		return;
+	}
+
+#if PROFILE
+	// Same for the profile, a line at a time
+	if(probe < CONSOLE_PROFILE_LINES){
+		if(ca->uart.space() >= CONSOLE_PROBE){
+			if(probe < N_PROBES)
+				_printProbe((t_probe) probe);
+			else
+				_printLatency((t_probe) (probe - N_PROBES));
+			probe++;
+		}
+		return;
+	}
+#endif
+
+	char c;
+	while(!ready && ca->uart.get(&c))
+		_receive(c);
+
+	// Wait until the reply fits
+	if(!ready || ca->uart.space() < CONSOLE_REPLY)
+		return;
+
+	if(overflow){
+		ca->uart.print_P(PSTR("? too long\n"));
+	}else{
+		t_command cmd;
+		command_parse(line, &cmd);
+		_run(&cmd);
+	}
+
+	length = 0;
+	overflow = false;
+	ready = false;
+}
+
+void Console::_receive(char c){
+	// Binary frame: a zero opens it, the next zero closes it
+	if(c == 0){
+		if(in_frame && frame_length > 0){
+			if(frame_length != 0xFF)
+				timesync->receive(frame, frame_length);
+			in_frame = false;
+		}else{
+			in_frame = true;
+		}
+		frame_length = 0;
+		return;
+	}
+	if(in_frame){
+		if(frame_length < sizeof(frame))
+			frame[frame_length++] = c;
+		else
+			frame_length = 0xFF;
+		return;
+	}
+
+	// Text line
+	if(c == '\r' || c == '\n'){
+		line[length] = '\0';
+		ready = true;
+	}else if(c == '\b' || c == 0x7F){
+		if(length > 0)
+			length--;
+	}else if(length < CONSOLE_LINE){
+		line[length++] = c;
+	}else{
+		overflow = true;
+	}
+}
+
+bool Console::busy(){
+	return dump != LOG_DUMP_END || probe < CONSOLE_PROFILE_LINES;
+}
+
+void Console::_run(const t_command* cmd){
+	Uart* uart = &ca->uart;
+
+	switch(cmd->id){
+	case CMD_EMPTY:
+		// CR LF, or just Enter
+		return;
+
+	case CMD_UNKNOWN:
+		uart->print_P(PSTR("? unknown, try help\n"));
+		return;
+
+	case CMD_INVALID:
+		uart->print_P(PSTR("? invalid value\n"));
+		return;
+
+	case CMD_HELP:
+		uart->print_P(PSTR("time alarm mode state stats log telemetry sync bus prof mem\n"));
+		return;
+
+	case CMD_TIME:
+		if(cmd->set){
+			// Same as setting the clock with the buttons
+			_setTime(ca->clock, cmd);
+			ca->stale = false;
+			checkpoint->request();
+			eventlog->logTime(LOG_TIME_SET);
+			break;
+		}
+		uart->print_P(PSTR("time "));
+		_printTime(ca->clock);
+		if(ca->stale)
+			uart->print_P(PSTR(" stale"));
+		uart->put('\n');
+		return;
+
+	case CMD_ALARM:
+		if(cmd->set){
+			// Saved by Settings once stable
+			_setTime(ca->alarm, cmd);
+			break;
+		}
+		uart->print_P(PSTR("alarm "));
+		_printTime(ca->alarm);
+		uart->put('\n');
+		return;
+
+	case CMD_MODE:
+		if(cmd->set){
+			ca->mode = cmd->hours == 12 ? H12 : H24;
+			break;
+		}
+		uart->print_P(ca->mode == H12 ? PSTR("mode 12\n") : PSTR("mode 24\n"));
+		return;
+
+	case CMD_STATE:
+		uart->print_P(PSTR("state "));
+		uart->print_P(STATE_NAMES[ca->state]);
+		uart->print_P(ca->io.getSwitch() ? PSTR(" switch on") : PSTR(" switch off"));
+		if(ca->snoozed)
+			uart->print_P(PSTR(" snoozed"));
+		uart->put('\n');
+		return;
+
+	case CMD_STATS:
+		uart->print_P(PSTR("stats up "));
+		uart->printDec(eventlog->getMinutes());
+		uart->print_P(PSTR(" rst "));
+		uart->printHex(checkpoint->getResetCause());
+		uart->print_P(PSTR(" rx "));
+		uart->printDec(uart->getRxLost());
+		uart->print_P(PSTR(" tx "));
+		uart->printDec(uart->getTxLost());
+		uart->print_P(PSTR(" log "));
+		uart->printDec(eventlog->getDropped());
+		uart->put('\n');
+		return;
+
+	case CMD_LOG:
+		dump = eventlog->dump(uart, 0);
+		return;
+
+	case CMD_TELEMETRY:
+		if(cmd->set){
+			telemetry->enable(cmd->hours);
+			break;
+		}
+		uart->print_P(telemetry->isEnabled() ? PSTR("telemetry on\n") : PSTR("telemetry off\n"));
+		return;
+
+	case CMD_SYNC:
+		if(cmd->set){
+			timesync->enable(cmd->hours);
+			break;
+		}
+		uart->print_P(timesync->isEnabled() ? PSTR("sync on") : PSTR("sync off"));
+		uart->print_P(PSTR(" n "));
+		uart->printDec(timesync->getCount());
+		uart->print_P(PSTR(" offset "));
+		_printSigned(timesync->getDiscipline()->getOffset());
+		uart->print_P(PSTR(" delay "));
+		_printSigned(timesync->getDiscipline()->getDelay());
+		uart->print_P(PSTR(" ppm "));
+		_printSigned(timesync->getDiscipline()->getPpm());
+		uart->put('\n');
+		return;
+
+	case CMD_BUS:
+		if(cmd->set){
+			ca->bus = (t_bus) cmd->hours;
+			break;
+		}
+		uart->print_P(PSTR("bus "));
+		uart->print_P(BUS_NAMES[ca->bus]);
+		uart->put('\n');
+		return;
+
+	case CMD_MEM:
+		{
+			uint16_t headroom = stack_headroom();
+
+			uart->print_P(PSTR("mem free "));
+			uart->printDec(stack_free());
+			uart->print_P(PSTR(" low "));
+			uart->printDec(headroom);
+			if(headroom < STACK_MIN_HEADROOM)
+				uart->print_P(PSTR(" !"));
+			uart->put('\n');
+		}
+		return;
+
+	case CMD_PROF:
+#if PROFILE
+		// Durations follow, in ticks of PROFILE_TICK_CYCLES cycles
+		uart->print_P(PSTR("prof tick "));
+		uart->printDec(PROFILE_TICK_CYCLES);
+		uart->put('\n');
+		probe = 0;
+#else
+		uart->print_P(PSTR("prof off\n"));
+#endif
+		return;
+	}
+
+	uart->print_P(PSTR("ok\n"));
+}
+
+#if PROFILE
+void Console::_printProbe(t_probe probe){
+	t_probe_stats stats;
+	profile_read(probe, &stats);
+
+	ca->uart.print_P(profile_name(probe));
+	ca->uart.print_P(PSTR(" n "));
+	ca->uart.printDec(stats.count);
+	if(stats.count > 0){
+		ca->uart.print_P(PSTR(" min "));
+		ca->uart.printDec(stats.min);
+		ca->uart.print_P(PSTR(" avg "));
+		ca->uart.printDec(stats.sum / stats.count);
+		ca->uart.print_P(PSTR(" max "));
+		ca->uart.printDec(stats.max);
+	}
+	ca->uart.put('\n');
+}
+
+void Console::_printLatency(t_probe probe){
+	uint16_t counts[N_LATENCY_BUCKETS];
+	profile_read_latency(probe, counts);
+
+	// Counts of 0, 1, 2-3, 4-7, ... ticks of that many cycles
+	ca->uart.print_P(profile_name(probe));
+	ca->uart.print_P(PSTR(" lat "));
+	ca->uart.printDec(profile_latency_cycles(probe));
+	ca->uart.put(':');
+	for(uint8_t i = 0; i < N_LATENCY_BUCKETS; i++){
+		ca->uart.put(' ');
+		ca->uart.printDec(counts[i]);
+	}
+	ca->uart.put('\n');
+}
+#endif
+
+void Console::_printTime(Clock& clock){
+	long value;
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		value = clock.getValue();
+	}
+
+	ca->uart.print2(value / H_SEC);
+	ca->uart.put(':');
+	ca->uart.print2((value % H_SEC) / M_SEC);
+	ca->uart.put(':');
+	ca->uart.print2(value % M_SEC);
+}
+
+void Console::_setTime(Clock& clock, const t_command* cmd){
+	long value = (long) cmd->hours * H_SEC + cmd->minutes * M_SEC + cmd->seconds;
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		clock.setValue(value);
+	}
+}
+
+void Console::_printSigned(int32_t value){
+	if(value < 0){
+		ca->uart.put('-');
+		value = -value;
+	}
+	// Offsets and delays beyond 65 s are clipped
+	ca->uart.printDec(value > 0xFFFF ? 0xFFFF : value);
+}
@@ -0,0 +1,147 @@
+#ifndef CONSOLE_H_
+#define CONSOLE_H_
+
+#include <stdint.h>
+
+#include "../constants.h"
+#include "CodAlarm.h"
+#include "Checkpoint.h"
+#include "Command.h"
+#include "EventLog.h"
+#include "Telemetry.h"
+#include "TimeSync.h"
+#include "../hw/Profile.h"
+#include "../hw/Stack.h"
+
+/**
+ * \brief Serial console, to configure CodAlarm and read its state without the buttons.
+ * Lines (terminated by CR or LF, see Command.h for the commands) are collected from the serial
+ * receive buffer and run from the main loop. Replies go to the serial transmit buffer: a line
+ * is only run once the whole reply fits, and the log is sent a piece at a time, so the console
+ * never waits for the serial line. Characters are not echoed. Binary frames (see Frame.h) are
+ * passed to TimeSync.
+ */
+class Console {
+
+public:
+	/**
+	 * Class constructor.
+	 * \param ca Pointer to CodAlarm Object instance.
+	 * \param checkpoint clock checkpoint, requested when the clock is set
+	 * \param eventlog event log, to log clock changes and dump the log
+	 * \param telemetry telemetry stream, started and stopped by command
+	 * \param timesync time synchronisation, started and stopped by command, receives the frames
+	 * \return
+	 */
+	Console(CodAlarm*, Checkpoint*, EventLog*, Telemetry*, TimeSync*);
+
+	/**
+	 * Reads received characters and runs complete lines. Must be called from the main loop.
+	 * \return void
+	 */
+	void poll();
+
+	/**
+	 * Returns whether a reply is being sent over several calls (log dump, profile): nothing else
+	 * may be sent on the serial port.
+	 * \return bool true if sending
+	 */
+	bool busy();
+
+private:
+	/** Pointer the instance of CodAlarm passed in the constructor */
+	CodAlarm* ca;
+
+	/** Clock checkpoint. */
+	Checkpoint* checkpoint;
+
+	/** Event log. */
+	EventLog* eventlog;
+
+	/** Telemetry stream. */
+	Telemetry* telemetry;
+
+	/** Time synchronisation. */
+	TimeSync* timesync;
+
+	/** Line being received, null terminated once complete. */
+	char line[CONSOLE_LINE + 1];
+
+	/** Number of characters in line. */
+	uint8_t length;
+
+	/** True if the line being received is longer than CONSOLE_LINE and will be rejected. */
+	bool overflow;
+
+	/** True if line is complete and waiting for room in the transmit buffer. */
+	bool ready;
+
+	/** Binary frame being received, delimiters excluded. */
+	uint8_t frame[SYNC_FRAME_MAX];
+
+	/** Number of bytes in frame, 0xFF if too long (discarded). */
+	uint8_t frame_length;
+
+	/** True between the delimiters of a binary frame. */
+	bool in_frame;
+
+	/** Position of the log dump in progress, LOG_DUMP_END if none. */
+	uint16_t dump;
+
+	/** Next line of the profile being sent, past the last one if none. */
+	uint8_t probe;
+
+	/**
+	 * Adds a received character to the line or to the binary frame.
+	 * \param c character
+	 * \return void
+	 */
+	void _receive(char);
+
+	/**
+	 * Runs a parsed command and sends the reply.
+	 * \param cmd command
+	 * \return void
+	 */
+	void _run(const t_command*);
+
+#if PROFILE
+	/**
+	 * Sends the durations of a probe, one line.
+	 * \param probe probe
+	 * \return void
+	 */
+	void _printProbe(t_probe);
+
+	/**
+	 * Sends the latency histogram of a timer interrupt, one line.
+	 * \param probe PROBE_TIMER0 or PROBE_TIMER1
+	 * \return void
+	 */
+	void _printLatency(t_probe);
+#endif
+
+	/**
+	 * Sends a clock value as HH:MM:SS, 24 hours.
+	 * \param clock clock
+	 * \return void
+	 */
+	void _printTime(Clock&);
+
+	/**
+	 * Sends a signed value in decimal.
+	 * \param value value
+	 * \return void
+	 */
+	void _printSigned(int32_t);
+
+	/**
+	 * Sets a clock value atomically, as clocks are read by the Timer1 interrupt.
+	 * \param clock clock
+	 * \param cmd command with the time
+	 * \return void
+	 */
+	static void _setTime(Clock&, const t_command*);
+};
+
+#endif /* CONSOLE_H_ */
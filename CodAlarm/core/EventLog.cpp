@@ -0,0 +1,188 @@
+#include "EventLog.h"
+
+#include <avr/pgmspace.h>
+#include <util/atomic.h>
+
+#include "Checkpoint.h"
+
+static_assert(EEPROM_CHECKPOINT + SlotRing::footprint(CHECKPOINT_SLOTS, sizeof(t_checkpoint)) <= EEPROM_LOG,
+		"EventLog: ring buffer overlaps checkpoints");
+static_assert(EEPROM_LOG + EEPROM_LOG_SIZE <= E2END + 1, "EventLog: ring buffer exceeds EEPROM");
+static_assert(EEPROM_LOG_SIZE % EEPROM_BUFFER == 0, "EventLog: ring buffer must be a multiple of a block");
+
+EventLog::EventLog(CodAlarm* _ca){
+	ca = _ca;
+	n_pending = 0;
+	dropped = 0;
+	head = 0;
+	lap = 0;
+	full = false;
+	seconds = 0;
+	minutes = 0;
+	last = 0;
+	oldest = 0;
+	dump_count = 0;
+}
+
+uint16_t EventLog::_read(uint16_t index){
+	uint16_t record;
+	ca->eeprom.read(&record, EEPROM_LOG + index * 2, 2);
+	return record;
+}
+
+void EventLog::init(){
+	uint16_t first = _read(0);
+	
+	// Write position: first erased record, or first record of the previous lap
+	head = 0;
+	lap = 0;
+	if(log_type(first) != LOG_ERASED){
+		lap = log_lap(first);
+		
+		for(head = 1; head < LOG_RECORDS; head++){
+			uint16_t record = _read(head);
+			if(log_type(record) == LOG_ERASED)
+				break;
+			if(log_lap(record) != lap){
+				full = true;
+				break;
+			}
+		}
+		
+		if(head == LOG_RECORDS){
+			// Lap completed
+			head = 0;
+			lap = !lap;
+			full = true;
+		}
+	}
+	
+	logTime(LOG_BOOT);
+}
+
+void EventLog::_append(t_log_type type, uint16_t value){
+	if(n_pending >= LOG_BATCH){
+		dropped++;
+		return;
+	}
+	
+	if(n_pending == 0)
+		oldest = minutes;
+	
+	// Lap bit is set when written
+	pending[n_pending++] = log_record(0, type, value);
+	last = minutes;
+}
+
+void EventLog::log(t_log_type type){
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		_append(type, minutes - last);
+	}
+}
+
+void EventLog::logTime(t_log_type type){
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		_append(type, ca->clock.getValue() / M_SEC);
+	}
+}
+
+void EventLog::tick(){
+	if(++seconds >= 60){
+		seconds = 0;
+		minutes++;
+	}
+}
+
+void EventLog::poll(){
+	uint16_t block[EEPROM_BUFFER / 2];
+	uint8_t n;
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		// Keep deltas in range
+		if((uint16_t) (minutes - last) >= LOG_VALUE_MAX)
+			_append(LOG_GAP, LOG_VALUE_MAX);
+		
+		// Write full blocks, or what is pending once old enough. Not while dumping: the positions
+		// of the records would change
+		if(n_pending == 0 || dump_count)
+			return;
+		if(n_pending < EEPROM_BUFFER / 2 && (uint16_t) (minutes - oldest) < LOG_FLUSH_PERIOD)
+			return;
+		if(ca->eeprom.busy())
+			return;
+		
+		n = n_pending < EEPROM_BUFFER / 2 ? n_pending : EEPROM_BUFFER / 2;
+		for(uint8_t i=0; i<n; i++)
+			block[i] = pending[i] | ((uint16_t) lap << 15);
+	}
+	
+	// Don't cross the end of the ring
+	if(head + n > LOG_RECORDS)
+		n = LOG_RECORDS - head;
+	
+	if(!ca->eeprom.write(EEPROM_LOG + head * 2, block, n * 2))
+		return;
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		// Remove written records
+		for(uint8_t i=n; i<n_pending; i++)
+			pending[i - n] = pending[i];
+		n_pending -= n;
+		oldest = minutes;
+	}
+	
+	head += n;
+	if(head >= LOG_RECORDS){
+		head = 0;
+		lap = !lap;
+		full = true;
+	}
+}
+
+uint16_t EventLog::dump(Uart* uart, uint16_t position){
+	uint16_t start = full ? head : 0;
+	uint16_t count = full ? LOG_RECORDS : head;
+	
+	// Longest item: "# log 65535\n"
+	while(uart->space() >= 12){
+		if(position == 0){
+			// Records logged during the dump are left out
+			dump_count = count + n_pending;
+			uart->print_P(PSTR("# log "));
+			uart->printDec(dump_count);
+			uart->put('\n');
+		}else if(position <= dump_count){
+			uint16_t i = position - 1;
+			
+			// Written records, oldest first, then records still in RAM
+			if(i < count)
+				uart->printHex(_read((start + i) % LOG_RECORDS));
+			else
+				uart->printHex(pending[i - count]);
+			uart->put((i % 8 == 7 || position == dump_count) ? '\n' : ' ');
+		}else{
+			uart->print_P(PSTR("# end\n"));
+			dump_count = 0;
+			return LOG_DUMP_END;
+		}
+		position++;
+	}
+	
+	return position;
+}
+
+uint16_t EventLog::getDropped(){
+	uint16_t n;
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		n = dropped;
+	}
+	return n;
+}
+
+uint16_t EventLog::getMinutes(){
+	uint16_t n;
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		n = minutes;
+	}
+	return n;
+}
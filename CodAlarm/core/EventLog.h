@@ -0,0 +1,148 @@
+#ifndef EVENTLOG_H_
+#define EVENTLOG_H_
+
+#include <stdint.h>
+
+#include "../constants.h"
+#include "../hw/Uart.h"
+#include "CodAlarm.h"
+#include "LogFormat.h"
+
+/** Number of records in the EEPROM ring buffer. */
+#define LOG_RECORDS		(EEPROM_LOG_SIZE / 2)
+
+/** Position returned by EventLog::dump() when the dump is complete. */
+#define LOG_DUMP_END	0xFFFF
+
+/**
+ * \brief History of alarm events, stored in an EEPROM ring buffer.
+ * Records are 2 bytes (see LogFormat.h): times are deltas in minutes from the previous record,
+ * anchored by the clock time at boot and when the clock is set. Records are kept in RAM and
+ * written in blocks of EEPROM_BUFFER bytes, when a block is full or after LOG_FLUSH_PERIOD
+ * minutes: up to LOG_FLUSH_PERIOD minutes of history are lost at power off. Each cell is written
+ * once per lap of the ring: at a few events a day a lap takes months.
+ */
+class EventLog {
+
+public:
+	/**
+	 * Class constructor.
+	 * \param ca Pointer to CodAlarm Object instance.
+	 * \return
+	 */
+	EventLog(CodAlarm*);
+	
+	/**
+	 * Finds the write position in the ring buffer and logs the boot.
+	 * \return void
+	 */
+	void init();
+	
+	/**
+	 * Logs an event. Safe to call from ISRs.
+	 * \param type event type (LOG_ALARM, LOG_SNOOZE, ...)
+	 * \return void
+	 */
+	void log(t_log_type);
+	
+	/**
+	 * Logs the current clock time (LOG_BOOT or LOG_TIME_SET). Safe to call from ISRs.
+	 * \param type event type
+	 * \return void
+	 */
+	void logTime(t_log_type);
+	
+	/**
+	 * Counts time. Must be called every second (Timer1 interrupt).
+	 * \return void
+	 */
+	void tick();
+	
+	/**
+	 * Writes pending records when due. Must be called from the main loop.
+	 * \return void
+	 */
+	void poll();
+	
+	/**
+	 * \brief Sends part of the log, oldest record first, as lines of hexadecimal records:
+	 *
+	 *     # log <count>
+	 *     1005 2003 ...
+	 *     # end
+	 *
+	 * Only what fits in the serial transmit buffer is sent, so the main loop is never held for
+	 * the whole dump: call with 0 to start, then again with the returned position until it is
+	 * LOG_DUMP_END. Records aren't written to EEPROM until the dump ends.
+	 * \param uart serial port
+	 * \param position dump position
+	 * \return next position, LOG_DUMP_END when done
+	 */
+	uint16_t dump(Uart*, uint16_t);
+	
+	/**
+	 * Returns the number of records lost because too many were waiting to be written.
+	 * \return count
+	 */
+	uint16_t getDropped();
+	
+	/**
+	 * Returns the minutes since boot.
+	 * \return minutes, wrapping after 45 days
+	 */
+	uint16_t getMinutes();
+
+private:
+	/** Pointer the instance of CodAlarm passed in the constructor */
+	CodAlarm* ca;
+	
+	/** Records waiting to be written. */
+	uint16_t pending[LOG_BATCH];
+	
+	/** Number of records in pending. */
+	volatile uint8_t n_pending;
+	
+	/** Records lost because pending was full. */
+	uint16_t dropped;
+	
+	/** Ring index of the next record written to EEPROM. */
+	uint16_t head;
+	
+	/** Lap bit of the next record written to EEPROM. */
+	uint8_t lap;
+	
+	/** True once the ring has wrapped: all records are valid. */
+	bool full;
+	
+	/** Seconds in the current minute. */
+	uint8_t seconds;
+	
+	/** Minutes since boot. */
+	volatile uint16_t minutes;
+	
+	/** Minutes since boot of the last record. */
+	uint16_t last;
+	
+	/** Minutes since boot of the oldest pending record. */
+	uint16_t oldest;
+	
+	/** Number of records in the dump in progress, 0 if none. */
+	uint16_t dump_count;
+	
+	/**
+	 * Appends a record to pending. Must be called with interrupts disabled.
+	 * \param type record type
+	 * \param value record value
+	 * \return void
+	 */
+	void _append(t_log_type, uint16_t);
+	
+	/**
+	 * Reads a record from the EEPROM ring buffer.
+	 * \param index ring index
+	 * \return record
+	 */
+	uint16_t _read(uint16_t);
+};
+
+#endif /* EVENTLOG_H_ */
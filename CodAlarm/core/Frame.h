@@ -0,0 +1,110 @@
+/*! \file */
+
+#ifndef FRAME_H_
+#define FRAME_H_
+
+#include <stdint.h>
+
+/*
+ * Binary frames on the serial line:
+ *
+ *     00  COBS(payload crc16)  00
+ *
+ * The first payload byte is the frame type. The CRC-16/CCITT (polynomial 0x8408 reflected, initial
+ * value 0xFFFF) covers the payload and is sent little endian. COBS encoding removes every zero
+ * byte, so frames are delimited by zeros and never mistaken for console text, which has none.
+ *
+ * This header is shared with the host tools and must not depend on AVR headers.
+ */
+
+// avr-libc, or its host replacement in hal/host when building the firmware logic on the host
+#if defined(__AVR__) || __has_include(<util/crc16.h>)
+#include <util/crc16.h>
+#else
+/** CRC-16/CCITT update, same as _crc_ccitt_update() of avr-libc. */
+static inline uint16_t _crc_ccitt_update(uint16_t crc, uint8_t data) {
+	data ^= crc & 0xFF;
+	data ^= data << 4;
+	return (((uint16_t) data << 8) | (crc >> 8)) ^ (uint8_t) (data >> 4) ^ ((uint16_t) data << 3);
+}
+#endif
+
+/** Initial value of the frame CRC. */
+#define FRAME_CRC_INIT	0xFFFF
+
+/**
+ * Computes the CRC of a payload.
+ * \param data payload
+ * \param n payload size
+ * \return CRC
+ */
+inline uint16_t frame_crc(const uint8_t* data, uint8_t n) {
+	uint16_t crc = FRAME_CRC_INIT;
+	while(n--)
+		crc = _crc_ccitt_update(crc, *data++);
+	return crc;
+}
+
+/**
+ * Encodes a frame: adds the CRC, COBS encodes and delimits the payload.
+ * \param data payload, at most 250 bytes
+ * \param n payload size
+ * \param out encoded frame, n + 5 bytes
+ * \return encoded frame size
+ */
+inline uint8_t frame_encode(const uint8_t* data, uint8_t n, uint8_t* out) {
+	uint16_t crc = frame_crc(data, n);
+	uint8_t code = 1;
+	uint8_t code_at = 1;
+	uint8_t o = 2;
+
+	out[0] = 0;
+	for(uint8_t i = 0; i < n + 2; i++) {
+		uint8_t c = i < n ? data[i] : (i == n ? crc & 0xFF : crc >> 8);
+		if(c == 0) {
+			out[code_at] = code;
+			code = 1;
+			code_at = o++;
+		} else {
+			out[o++] = c;
+			code++;
+		}
+	}
+	out[code_at] = code;
+	out[o++] = 0;
+
+	return o;
+}
+
+/**
+ * Decodes a COBS encoded frame, delimiters removed, and checks its CRC.
+ * \param in encoded bytes
+ * \param n number of encoded bytes
+ * \param out decoded payload, without the CRC; at least n bytes
+ * \return payload size, -1 if the frame is malformed or the CRC doesn't match
+ */
+inline int16_t frame_decode(const uint8_t* in, uint8_t n, uint8_t* out) {
+	uint8_t i = 0;
+	uint8_t o = 0;
+
+	while(i < n) {
+		uint8_t code = in[i++];
+		if(code == 0 || code - 1 > n - i)
+			return -1;
+		for(uint8_t j = 1; j < code; j++)
+			out[o++] = in[i++];
+		if(code < 0xFF && i < n)
+			out[o++] = 0;
+	}
+
+	if(o < 3)
+		return -1;
+
+	o -= 2;
+	if(frame_crc(out, o) != (uint16_t) (out[o] | out[o + 1] << 8))
+		return -1;
+
+	return o;
+}
+
+#endif /* FRAME_H_ */
@@ -1,8 +1,16 @@
 #include "GUI.h"
 
+#include "../hw/Profile.h"
+#include "../hw/Trace.h"
+
 
 GUI::GUI(CodAlarm* _ca){
 	ca = _ca;
+	redraws = 0;
+	
+	// Display buffer starts empty
+	for(int i=0; i<N_WIDGETS; i++)
+		shown[i] = SYM_NONE;
 }
 
 void GUI::_drawSymbol(int pos_x, int pos_y, t_symbol c, int scale){
@@ -18,8 +26,11 @@ void GUI::_drawSymbol(int pos_x, int pos_y, t_symbol c, int scale){
 	for(int y=pos_y; y<pos_y+height; y++){
 		for(int x=pos_x; x<pos_x+width; x++)
 		{
-			int block = ((y-pos_y)/2)/scale;
-			int pos = (7-(((y-pos_y)%2)*4+(x-pos_x)))/scale;
+			// Symbol pixel: two rows of 4 pixels per byte, high nibble first
+			int row = (y-pos_y)/scale;
+			int col = (x-pos_x)/scale;
+			int block = row/2;
+			int pos = 7-((row%2)*4+col);
 			
 			char buf;
 
@@ -87,6 +98,10 @@ void GUI::_drawSymbol(int pos_x, int pos_y, t_symbol c, int scale){
 				case SYM_BELL_R:
 				buf=bell_right[block];
 				break;
+				
+				default:
+				buf=0;
+				break;
 			}
 
 			int value = CHECK_BIT(buf,pos);
@@ -98,78 +113,81 @@ void GUI::_drawSymbol(int pos_x, int pos_y, t_symbol c, int scale){
 
 bool GUI::_blinkState(){
 	// This is only cosmetic, no precise timing is required!
-	return TCNT1 > 7812 ? true : false;
+	return hal_timer1_count() > TIMER1_CMP / 2 ? true : false;
 }
 
-void GUI::draw(){
+void GUI::_drawWidget(t_widget widget, t_symbol c){
 	
-	// Clear screen buffer
-	ca->display.clear();
+	// Unchanged: nothing to redraw
+	if(shown[widget] == c)
+		return;
 	
-	// Draw clock digits
-	int clock_hour = ca->clock.getHour(ca->mode);
-	int clock_min = ca->clock.getMin();
+	int x = pgm_read_byte(&WIDGETS[widget].x);
+	int y = pgm_read_byte(&WIDGETS[widget].y);
+	int w = pgm_read_byte(&WIDGETS[widget].w);
+	int h = pgm_read_byte(&WIDGETS[widget].h);
 	
-	if((ca->state != SET_CLOCK1) | (ca->state != SET_CLOCK1 && _blinkState())){
-		t_symbol hour_h = (t_symbol) (H_DDIG(clock_hour));
-		t_symbol hour_l = (t_symbol) (L_DDIG(clock_hour));
-		_drawSymbol(17,5, hour_h, SCALE_BIG);	// 1st hour digit
-		_drawSymbol(37,5, hour_l, SCALE_BIG);	// 2nd hour digit
-	}
+	ca->display.clear(x, y, w, h);
 	
-	_drawSymbol(55,5, SYM_COLUMN, SCALE_BIG);				// Clock column
+	if(c != SYM_NONE)
+		_drawSymbol(x, y, c, w / SIZE_BASE_W);
 	
-	if((ca->state != SET_CLOCK2) | (ca->state != SET_CLOCK2 && _blinkState())){
-		t_symbol min_h = (t_symbol) (H_DDIG(clock_min));
-		t_symbol min_l = (t_symbol) (L_DDIG(clock_min));
-		_drawSymbol(73,5, min_h, SCALE_BIG);	// 1st min digit
-		_drawSymbol(93,5, min_l, SCALE_BIG);	// 2nd min digit
-	}
+	shown[widget] = c;
+	redraws++;
+}
+
+void GUI::_drawTime(Clock& clock, t_widget first, bool hour, bool min, bool column){
 	
-	if(ca->mode == H12){
-		if (ca->clock.isAm()){
-			_drawSymbol(111, 5, SYM_A, SCALE_SMALL);
-		}else{
-			_drawSymbol(111, 5, SYM_A, SCALE_SMALL);
-		}
-		_drawSymbol(116, 5, SYM_M, SCALE_SMALL);
-	}
+	int value_hour = clock.getHour(ca->mode);
+	int value_min = clock.getMin();
 	
-	// Draw alarm digits
-	int alarm_hour = ca->alarm.getHour(ca->mode);
-	int alarm_min = ca->alarm.getMin();
-		
-	if((ca->state != SET_ALARM1) | (ca->state != SET_ALARM1 && _blinkState())){
-		t_symbol hour_h = (t_symbol) (H_DDIG(alarm_hour));
-		t_symbol hour_l = (t_symbol) (L_DDIG(alarm_hour));
-		_drawSymbol(17,43, hour_h, SCALE_BIG);	// 1st hour digit
-		_drawSymbol(27,43, hour_l, SCALE_BIG);	// 2nd hour digit
-	}
-		
-	_drawSymbol(35,43, SYM_COLUMN, SCALE_BIG);				// Alarm column
-		
-	if((ca->state != SET_ALARM2) | (ca->state != SET_ALARM2 && _blinkState())){
-		t_symbol min_h = (t_symbol) (H_DDIG(alarm_min));
-		t_symbol min_l = (t_symbol) (L_DDIG(alarm_min));
-		_drawSymbol(43,43, min_h, SCALE_BIG);	// 1st min digit
-		_drawSymbol(53,43, min_l, SCALE_BIG);	// 2nd min digit
-	}
-		
+	// Digits
+	_drawWidget((t_widget) (first + 0), hour ? (t_symbol) (H_DDIG(value_hour)) : SYM_NONE);	// 1st hour digit
+	_drawWidget((t_widget) (first + 1), hour ? (t_symbol) (L_DDIG(value_hour)) : SYM_NONE);	// 2nd hour digit
+	_drawWidget((t_widget) (first + 2), column ? SYM_COLUMN : SYM_NONE);						// Column
+	_drawWidget((t_widget) (first + 3), min ? (t_symbol) (H_DDIG(value_min)) : SYM_NONE);		// 1st min digit
+	_drawWidget((t_widget) (first + 4), min ? (t_symbol) (L_DDIG(value_min)) : SYM_NONE);		// 2nd min digit
+	
+	// AM/PM
 	if(ca->mode == H12){
-		if (ca->alarm.isAm()){
-			_drawSymbol(63, 43, SYM_A, SCALE_SMALL);
-			}else{
-			_drawSymbol(63, 43, SYM_A, SCALE_SMALL);
-		}
-		_drawSymbol(68, 43, SYM_M, SCALE_SMALL);
+		_drawWidget((t_widget) (first + 5), clock.isAm() ? SYM_A : SYM_P);
+		_drawWidget((t_widget) (first + 6), SYM_M);
+	}else{
+		_drawWidget((t_widget) (first + 5), SYM_NONE);
+		_drawWidget((t_widget) (first + 6), SYM_NONE);
 	}
+}
+
+void GUI::draw(){
+	TRACE_BEGIN(Frame);
+	PROFILE_BEGIN(PROBE_DRAW);
+	
+	bool blink = _blinkState();
+	
+	// Draw clock, the digits being set blink, the column too if the time was restored after a
+	// power loss and may be late
+	_drawTime(ca->clock, W_CLOCK_HOUR_H, ca->state != SET_CLOCK1 || blink, ca->state != SET_CLOCK2 || blink,
+			!ca->stale || blink);
+	
+	// Draw alarm
+	_drawTime(ca->alarm, W_ALARM_HOUR_H, ca->state != SET_ALARM1 || blink, ca->state != SET_ALARM2 || blink, true);
 	
 	// Draw alarm symbol
 	if(ca->io.getSwitch()){
-		_drawSymbol(77, 53, SYM_BELL_L, SCALE_SMALL);
-		_drawSymbol(78, 53, SYM_BELL_R, SCALE_SMALL);
+		_drawWidget(W_BELL_L, SYM_BELL_L);
+		_drawWidget(W_BELL_R, SYM_BELL_R);
+	}else{
+		_drawWidget(W_BELL_L, SYM_NONE);
+		_drawWidget(W_BELL_R, SYM_NONE);
 	}
 	
-	// Send screen update
+	// Send screen update, changed areas only
 	ca->display.update();
+	
+	PROFILE_END(PROBE_DRAW);
+	TRACE_END(Frame);
+}
+
+uint16_t GUI::getRedraws(){
+	return redraws;
 }
\ No newline at end of file
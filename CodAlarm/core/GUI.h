@@ -1,10 +1,10 @@
 #ifndef GUI_H_
 #define GUI_H_
 
-#include <avr/io.h>
-
 #include "../constants.h"
+#include "../hal/Hal.h"
 #include "CodAlarm.h"
+#include "Layout.h"
 
 /** Returns the units digit for a decimal value */
 #define L_DDIG(x) x%10
@@ -12,16 +12,6 @@
 /** Returns the tens digit for a decimal value */
 #define H_DDIG(x) x/10
 
-/** Symbol width in pixel  */
-#define SIZE_BASE_W		4
-
-/** Symbol height in pixel */
-#define SIZE_BASE_H		8
-
-#define SCALE_SMALL		1
-#define SCALE_NORMAL	2
-#define SCALE_BIG		4
-
 /** Symbol type */
 enum t_symbol {
 	SYM_0,
@@ -40,6 +30,8 @@ enum t_symbol {
 	SYM_COLUMN,
 	SYM_BELL_R,	
 	SYM_BELL_L,	
+	/** Nothing drawn */
+	SYM_NONE,
 };
 
 // Numbers
@@ -80,15 +72,28 @@ public:
     GUI(CodAlarm*);
 
     /**
-     * Draws the interface on the screen.
+     * Draws the interface on the screen. Only the widgets whose symbol changed since the
+     * last call are cleared and redrawn, and only their area is sent to the display.
      * \return void
      */
     void draw();
 
+    /**
+     * Returns the number of widgets redrawn since power up. Wraps around.
+     * \return count
+     */
+    uint16_t getRedraws();
+
 private:
 	/** Pointer the instance of CodAlarm passed in the constructor */
     CodAlarm* ca;
 	
+	/** Symbol currently shown by each widget. */
+	t_symbol shown[N_WIDGETS];
+	
+	/** Widgets redrawn. */
+	uint16_t redraws;
+	
 	
     /**
 	 * Draws a symbol on the screen at the specified coordinate (upper left corner of the symbol), with
@@ -106,6 +111,25 @@ private:
      */
     void _drawSymbol(int, int, t_symbol, int);
 	
+    /**
+     * Shows a symbol in a widget. The widget area is cleared and redrawn only if the symbol changed.
+     * \param widget Widget
+     * \param c Symbol to be shown, SYM_NONE to leave the widget empty
+     * \return void
+     */
+    void _drawWidget(t_widget, t_symbol);
+
+    /**
+     * Shows the value of a clock in the widgets that follow a given one, as ordered in t_widget.
+     * \param clock Clock to be shown
+     * \param first Widget of the first hour digit
+     * \param hour true to show the hour, false to hide it (blinking)
+     * \param min true to show the minutes, false to hide them (blinking)
+     * \param column true to show the column, false to hide it (blinking)
+     * \return void
+     */
+    void _drawTime(Clock&, t_widget, bool, bool, bool);
+
     /**
      * Provides the blinking animation by reading Timer1.
      * \return bool Commutes periodically.
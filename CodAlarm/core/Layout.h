@@ -0,0 +1,170 @@
+/*! \file */
+
+#ifndef LAYOUT_H_
+#define LAYOUT_H_
+
+#include <stdint.h>
+#include <avr/pgmspace.h>
+
+/** Screen width in pixel */
+#define SCREEN_W		128
+
+/** Screen height in pixel */
+#define SCREEN_H		64
+
+/** Symbol width in pixel  */
+#define SIZE_BASE_W		4
+
+/** Symbol height in pixel */
+#define SIZE_BASE_H		8
+
+#define SCALE_SMALL		1
+#define SCALE_NORMAL	2
+#define SCALE_BIG		4
+
+/** Screen area, in pixel. */
+struct t_rect {
+	uint8_t x;
+	uint8_t y;
+	uint8_t w;
+	uint8_t h;
+};
+
+/** Row of symbols with the same scale, placed left to right. */
+struct t_row {
+	/** Position of the first symbol (upper left corner). */
+	uint8_t x;
+	uint8_t y;
+	/** Upscale value of the symbols. */
+	uint8_t scale;
+	/** Horizontal space between two symbols, in pixel. */
+	uint8_t spacing;
+};
+
+/**
+ * Returns the area of a symbol in a row.
+ * \param row row
+ * \param column symbol index in the row, from 0
+ * \return symbol area
+ */
+constexpr t_rect layout_cell(t_row row, uint8_t column) {
+	return t_rect { (uint8_t) (row.x + column * (SIZE_BASE_W * row.scale + row.spacing)), row.y,
+		(uint8_t) (SIZE_BASE_W * row.scale), (uint8_t) (SIZE_BASE_H * row.scale) };
+}
+
+/**
+ * Returns the upscale value of a symbol from its area.
+ * \param rect symbol area
+ * \return upscale value
+ */
+constexpr uint8_t layout_scale(t_rect rect) {
+	return rect.w / SIZE_BASE_W;
+}
+
+/**
+ * Checks if two areas share at least one pixel.
+ * \return true if they overlap
+ */
+constexpr bool layout_overlap(t_rect a, t_rect b) {
+	return a.x < b.x + b.w && b.x < a.x + a.w && a.y < b.y + b.h && b.y < a.y + a.h;
+}
+
+/**
+ * Checks that every area is inside the screen.
+ * \param rects areas
+ * \param n number of areas
+ * \return true if all of them fit
+ */
+constexpr bool layout_fits(const t_rect* rects, uint8_t n) {
+	for(uint8_t i = 0; i < n; i++) {
+		if(rects[i].x + rects[i].w > SCREEN_W || rects[i].y + rects[i].h > SCREEN_H)
+			return false;
+	}
+	return true;
+}
+
+/**
+ * Checks that no two areas overlap, so each of them can be cleared and redrawn alone.
+ * \param rects areas
+ * \param n number of areas
+ * \return true if they are disjoint
+ */
+constexpr bool layout_disjoint(const t_rect* rects, uint8_t n) {
+	for(uint8_t i = 0; i < n; i++) {
+		for(uint8_t j = i + 1; j < n; j++) {
+			if(layout_overlap(rects[i], rects[j]))
+				return false;
+		}
+	}
+	return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// LAYOUT
+//////////////////////////////////////////////////////////////////////////
+
+/** Clock digits and column. */
+constexpr t_row ROW_CLOCK		= { 17, 5, SCALE_BIG, 3 };
+
+/** Clock AM/PM. */
+constexpr t_row ROW_CLOCK_AMPM	= { 111, 5, SCALE_SMALL, 1 };
+
+/** Alarm digits and column. */
+constexpr t_row ROW_ALARM		= { 17, 43, SCALE_NORMAL, 2 };
+
+/** Alarm AM/PM. */
+constexpr t_row ROW_ALARM_AMPM	= { 67, 43, SCALE_SMALL, 1 };
+
+/** Bell icon. */
+constexpr t_row ROW_BELL		= { 80, 53, SCALE_SMALL, 0 };
+
+/**
+ * Screen elements, each one holding a single symbol. Indexes WIDGETS. Clock and alarm widgets
+ * are in the same order, so they can be addressed from their first one.
+ */
+enum t_widget {
+	W_CLOCK_HOUR_H,
+	W_CLOCK_HOUR_L,
+	W_CLOCK_COLUMN,
+	W_CLOCK_MIN_H,
+	W_CLOCK_MIN_L,
+	W_CLOCK_AMPM,
+	W_CLOCK_M,
+	W_ALARM_HOUR_H,
+	W_ALARM_HOUR_L,
+	W_ALARM_COLUMN,
+	W_ALARM_MIN_H,
+	W_ALARM_MIN_L,
+	W_ALARM_AMPM,
+	W_ALARM_M,
+	W_BELL_L,
+	W_BELL_R,
+};
+
+/** Number of widgets in t_widget. */
+#define N_WIDGETS		16
+
+/** Widget areas, in the order of t_widget. Stored in flash. */
+constexpr t_rect WIDGETS[N_WIDGETS] PROGMEM = {
+	layout_cell(ROW_CLOCK, 0),
+	layout_cell(ROW_CLOCK, 1),
+	layout_cell(ROW_CLOCK, 2),
+	layout_cell(ROW_CLOCK, 3),
+	layout_cell(ROW_CLOCK, 4),
+	layout_cell(ROW_CLOCK_AMPM, 0),
+	layout_cell(ROW_CLOCK_AMPM, 1),
+	layout_cell(ROW_ALARM, 0),
+	layout_cell(ROW_ALARM, 1),
+	layout_cell(ROW_ALARM, 2),
+	layout_cell(ROW_ALARM, 3),
+	layout_cell(ROW_ALARM, 4),
+	layout_cell(ROW_ALARM_AMPM, 0),
+	layout_cell(ROW_ALARM_AMPM, 1),
+	layout_cell(ROW_BELL, 0),
+	layout_cell(ROW_BELL, 1),
+};
+
+static_assert(layout_fits(WIDGETS, N_WIDGETS), "Layout: widget out of screen");
+static_assert(layout_disjoint(WIDGETS, N_WIDGETS), "Layout: widgets overlap");
+
+#endif /* LAYOUT_H_ */
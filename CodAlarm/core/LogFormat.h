@@ -0,0 +1,65 @@
+/*! \file */
+
+#ifndef LOGFORMAT_H_
+#define LOGFORMAT_H_
+
+#include <stdint.h>
+
+/*
+ * Event log record, 16 bits:
+ *
+ *     15    14..12   11..0
+ *     lap   type     value
+ *
+ * For LOG_BOOT and LOG_TIME_SET the value is the clock time in minutes from midnight, an anchor
+ * for the records that follow. For the other types it is the number of minutes elapsed since the
+ * previous record. LOG_GAP only adds elapsed time, so that no delta exceeds LOG_VALUE_MAX. The lap
+ * bit flips each time the ring buffer wraps: the write position is where it changes.
+ *
+ * This header is shared with the host decoder (tools/logdecode) and must not depend on AVR headers.
+ */
+
+/** Event log record type. */
+enum t_log_type {
+	/** Power up, value is the clock time. */
+	LOG_BOOT,
+	/** Clock set by the user, value is the new clock time. */
+	LOG_TIME_SET,
+	/** Alarm started ringing. */
+	LOG_ALARM,
+	/** Alarm snoozed. */
+	LOG_SNOOZE,
+	/** Alarm stopped with the button. */
+	LOG_STOP,
+	/** Alarm stopped with the switch. */
+	LOG_SWITCH_OFF,
+	/** Time elapsed without events. */
+	LOG_GAP,
+	/** Never written (erased EEPROM reads 0xFFFF). */
+	LOG_ERASED
+};
+
+/** Largest value of a record. */
+#define LOG_VALUE_MAX	0x0FFF
+
+/** Returns a record. */
+inline uint16_t log_record(uint8_t lap, uint8_t type, uint16_t value) {
+	return ((uint16_t) (lap & 1) << 15) | ((uint16_t) (type & 7) << 12) | (value & LOG_VALUE_MAX);
+}
+
+/** Returns the lap bit of a record. */
+inline uint8_t log_lap(uint16_t record) {
+	return record >> 15;
+}
+
+/** Returns the type of a record. */
+inline t_log_type log_type(uint16_t record) {
+	return (t_log_type) ((record >> 12) & 7);
+}
+
+/** Returns the value of a record. */
+inline uint16_t log_value(uint16_t record) {
+	return record & LOG_VALUE_MAX;
+}
+
+#endif /* LOGFORMAT_H_ */
@@ -0,0 +1,64 @@
+#include "Settings.h"
+
+static_assert(sizeof(t_settings) <= SLOT_PAYLOAD_MAX, "Settings: record too large for a slot");
+
+Settings::Settings(CodAlarm* _ca) :
+	ring(&_ca->eeprom, EEPROM_SETTINGS, SETTINGS_SLOTS, sizeof(t_settings)) {
+	
+	ca = _ca;
+	countdown = 0;
+	
+	_current(&saved);
+	pending = saved;
+}
+
+void Settings::_current(t_settings* settings){
+	settings->alarm = ca->alarm.getValue() / M_SEC;
+	settings->mode = ca->mode;
+	settings->bus = ca->bus;
+}
+
+bool Settings::_equal(const t_settings* a, const t_settings* b){
+	return a->alarm == b->alarm && a->mode == b->mode && a->bus == b->bus;
+}
+
+void Settings::load(){
+	t_settings stored;
+	
+	if(!ring.load(&stored))
+		return;		// Never saved: keep defaults
+	
+	// Ignore out of range values
+	if(stored.alarm < D_SEC / M_SEC)
+		ca->alarm.setValue((long) stored.alarm * M_SEC);
+	if(stored.mode == H12 || stored.mode == H24)
+		ca->mode = (t_mode) stored.mode;
+	if(stored.bus <= BUS_SLAVE)
+		ca->bus = (t_bus) stored.bus;
+	
+	_current(&saved);
+	pending = saved;
+}
+
+void Settings::tick(){
+	if(countdown > 0)
+		countdown--;
+}
+
+void Settings::poll(){
+	t_settings current;
+	_current(&current);
+	
+	if(!_equal(&current, &pending)){
+		// Changed: wait until stable
+		pending = current;
+		countdown = SETTINGS_DELAY;
+		return;
+	}
+	
+	if(countdown == 0 && !_equal(&pending, &saved)){
+		// Stable and not saved yet
+		if(ring.save(&pending))
+			saved = pending;
+	}
+}
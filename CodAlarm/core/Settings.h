@@ -0,0 +1,83 @@
+#ifndef SETTINGS_H_
+#define SETTINGS_H_
+
+#include <stdint.h>
+
+#include "../constants.h"
+#include "CodAlarm.h"
+#include "SlotRing.h"
+
+/** Settings saved in EEPROM. */
+struct t_settings {
+	/** Alarm time, minutes from midnight. */
+	uint16_t alarm;
+	/** Hour format (t_mode). */
+	uint8_t mode;
+	/** Role on the time bus (t_bus). */
+	uint8_t bus;
+};
+
+/**
+ * \brief Keeps the user settings of CodAlarm in EEPROM.
+ * Changes are saved only once they have been stable for SETTINGS_DELAY seconds, so that setting
+ * the alarm with the Up/Down buttons costs a single write. Writes rotate over SETTINGS_SLOTS slots.
+ */
+class Settings {
+
+public:
+	/**
+	 * Class constructor.
+	 * \param ca Pointer to CodAlarm Object instance.
+	 * \return
+	 */
+	Settings(CodAlarm*);
+	
+	/**
+	 * Loads the saved settings into CodAlarm. Defaults are kept if nothing was saved.
+	 * \return void
+	 */
+	void load();
+	
+	/**
+	 * Counts the time settings have been stable. Must be called every second (Timer1 interrupt).
+	 * \return void
+	 */
+	void tick();
+	
+	/**
+	 * Detects changes and saves settings once stable. Must be called from the main loop.
+	 * \return void
+	 */
+	void poll();
+
+private:
+	/** Pointer the instance of CodAlarm passed in the constructor */
+	CodAlarm* ca;
+	
+	/** Slots in EEPROM. */
+	SlotRing ring;
+	
+	/** Last saved (or loaded) settings. */
+	t_settings saved;
+	
+	/** Settings waiting to be stable. */
+	t_settings pending;
+	
+	/** Seconds before pending can be saved. */
+	volatile uint8_t countdown;
+	
+	/**
+	 * Reads the current settings from CodAlarm.
+	 * \param settings destination
+	 * \return void
+	 */
+	void _current(t_settings*);
+	
+	/**
+	 * Compares two settings.
+	 * \return bool true if equal
+	 */
+	static bool _equal(const t_settings*, const t_settings*);
+};
+
+#endif /* SETTINGS_H_ */
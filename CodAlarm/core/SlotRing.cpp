@@ -0,0 +1,68 @@
+#include "SlotRing.h"
+
+#include <util/crc16.h>
+
+SlotRing::SlotRing(Eeprom* _eeprom, uint16_t _base, uint8_t _n_slots, uint8_t _size){
+	eeprom = _eeprom;
+	base = _base;
+	n_slots = _n_slots;
+	size = _size;
+	
+	// Until loaded, start from the first slot
+	next = 0;
+	seq = 0;
+}
+
+uint8_t SlotRing::_crc(const uint8_t* slot){
+	// Not 0: a slot of zeros, or a block followed by its own CRC, would match. Then the payload
+	// size, so that the slots of a record of another layout don't match either
+	uint8_t crc = _crc8_ccitt_update(0xFF, size);
+	for(uint8_t i=0; i<size + 1; i++)
+		crc = _crc8_ccitt_update(crc, slot[i]);
+	return crc;
+}
+
+bool SlotRing::load(void* payload){
+	uint8_t slot[EEPROM_BUFFER];
+	bool found = false;
+	uint8_t newest = 0;
+	
+	for(uint8_t i=0; i<n_slots; i++){
+		eeprom->read(slot, base + (uint16_t) i * (size + 2), size + 2);
+		
+		// Discard erased or torn slots
+		if(_crc(slot) != slot[size + 1])
+			continue;
+		
+		// Newer than the best so far (serial number arithmetic)
+		if(!found || (int8_t) (slot[0] - newest) > 0){
+			found = true;
+			newest = slot[0];
+			next = (i + 1) % n_slots;
+			
+			for(uint8_t j=0; j<size; j++)
+				((uint8_t*) payload)[j] = slot[1 + j];
+		}
+	}
+	
+	if(found)
+		seq = newest + 1;
+	
+	return found;
+}
+
+bool SlotRing::save(const void* payload){
+	uint8_t slot[EEPROM_BUFFER];
+	
+	slot[0] = seq;
+	for(uint8_t j=0; j<size; j++)
+		slot[1 + j] = ((const uint8_t*) payload)[j];
+	slot[size + 1] = _crc(slot);
+	
+	if(!eeprom->write(base + (uint16_t) next * (size + 2), slot, size + 2))
+		return false;
+	
+	next = (next + 1) % n_slots;
+	seq++;
+	return true;
+}
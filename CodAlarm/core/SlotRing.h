@@ -0,0 +1,87 @@
+#ifndef SLOTRING_H_
+#define SLOTRING_H_
+
+#include <stdint.h>
+
+#include "../hw/Eeprom.h"
+
+/** Largest payload of a slot, in bytes: the slot adds a sequence number and a CRC. */
+#define SLOT_PAYLOAD_MAX	(EEPROM_BUFFER - 2)
+
+/**
+ * \brief Wear-levelled record store in EEPROM.
+ * A record is saved in the slot following the last saved one, so that each EEPROM cell is written
+ * once every n_slots saves. Each slot holds a sequence number, the payload and a CRC8 of both:
+ *
+ *     | seq | payload (size bytes) | crc |
+ *
+ * The newest valid slot is the one with the highest sequence number (in serial number arithmetic,
+ * so the 8-bit counter can wrap). A slot interrupted by a power loss fails the CRC and is ignored,
+ * leaving the previous record. The CRC starts from 0xFF: erased (0xFF) and zeroed slots never
+ * match it. It also covers the payload size, so that a ring whose record changes size discards
+ * the records of the old layout instead of reading them shifted.
+ */
+class SlotRing {
+
+public:
+    /**
+     * Class constructor.
+     * \param eeprom EEPROM wrapper
+     * \param base address of the first slot
+     * \param n_slots number of slots, less than 128
+     * \param size payload size, at most SLOT_PAYLOAD_MAX
+     * \return
+     */
+    SlotRing(Eeprom*, uint16_t, uint8_t, uint8_t);
+
+    /**
+     * Finds the newest valid record with a single scan of the slots.
+     * \param payload buffer receiving the record
+     * \return bool false if no slot is valid: payload is unchanged
+     */
+    bool load(void*);
+
+    /**
+     * Starts saving a record in the next slot, in background.
+     * \param payload record
+     * \return bool false if the EEPROM is busy: retry later
+     */
+    bool save(const void*);
+
+    /**
+     * Returns the EEPROM space used by a ring.
+     * \param n_slots number of slots
+     * \param size payload size
+     * \return size in bytes
+     */
+    static constexpr uint16_t footprint(uint8_t n_slots, uint8_t size) {
+        return (uint16_t) n_slots * (size + 2);
+    }
+
+private:
+    Eeprom* eeprom;
+
+    /** Address of the first slot. */
+    uint16_t base;
+
+    /** Number of slots. */
+    uint8_t n_slots;
+
+    /** Payload size. */
+    uint8_t size;
+
+    /** Slot written by the next save. */
+    uint8_t next;
+
+    /** Sequence number of the next save. */
+    uint8_t seq;
+
+    /**
+     * Computes the CRC of a slot, payload size first.
+     * \param slot slot bytes, without the CRC
+     * \return CRC8, from 0xFF
+     */
+    uint8_t _crc(const uint8_t*);
+};
+
+#endif /* SLOTRING_H_ */
@@ -0,0 +1,75 @@
+/*! \file */
+
+#ifndef STATEMACHINE_H_
+#define STATEMACHINE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <avr/pgmspace.h>
+#include <util/atomic.h>
+
+#include "CodAlarm.h"
+
+/** Transition action. NULL if the transition only changes state. */
+typedef void (*Action) (void);
+
+/**
+ * Row of the transition table: when event happens in state, next becomes the current state and
+ * action is called.
+ */
+struct t_transition {
+	/** Current state. */
+	uint8_t state;
+	/** Event received. */
+	uint8_t event;
+	/** Action performed, can be NULL. */
+	Action action;
+	/** Next state. */
+	uint8_t next;
+};
+
+/** Declares a row of the transition table. */
+#define TRANSITION(state, event, action, next)	{ state, event, action, next }
+
+/**
+ * \brief Checks a transition table at compile time.
+ * The table must have a row for each state and event pair, sorted by state and then by event, so
+ * that the row of a pair is found by index. Every next state must exist.
+ * \param table transition table
+ * \param n number of rows
+ * \return true if the table is complete and sorted
+ */
+constexpr bool fsm_check(const t_transition* table, uint16_t n) {
+	if(n != N_STATES * N_EVENTS)
+		return false;
+
+	for(uint16_t i = 0; i < n; i++) {
+		if(table[i].state != i / N_EVENTS || table[i].event != i % N_EVENTS || table[i].next >= N_STATES)
+			return false;
+	}
+	return true;
+}
+
+/**
+ * \brief Executes a transition.
+ * The row is read from the table in flash by index, so dispatch time doesn't depend on the number
+ * of states and events. The state change and the action are atomic, as events are sent both from
+ * the main loop and from ISRs. Actions must be short.
+ * \param table transition table in flash, checked by fsm_check()
+ * \param state current state, updated
+ * \param event event received
+ * \return void
+ */
+inline void fsm_dispatch(const t_transition* table, t_state& state, t_event event) {
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		const t_transition* row = &table[state * N_EVENTS + event];
+
+		state = (t_state) pgm_read_byte(&row->next);
+
+		Action action = (Action) pgm_read_ptr(&row->action);
+		if(action)
+			action();
+	}
+}
+
+#endif /* STATEMACHINE_H_ */
@@ -0,0 +1,88 @@
+/*! \file */
+
+#ifndef SYNCFORMAT_H_
+#define SYNCFORMAT_H_
+
+#include <stdint.h>
+
+/*
+ * Time synchronisation exchange, NTP-like, sent as binary frames (see Frame.h):
+ *
+ *     CodAlarm                      host
+ *        |------ t_sync_request ----->|   T1 end of the request, CodAlarm clock
+ *        |                            |   T2 request received, host clock
+ *        |<----- t_sync_response -----|   T3 response sent, host clock
+ *        |                            |   T4 start of the response, CodAlarm clock
+ *
+ * CodAlarm takes T1 when the last byte of the request leaves the transmitter, and T4 from the
+ * arrival of the last byte of the response minus its transmission time. Then:
+ *
+ *     offset = ((T2 - T1) + (T3 - T4)) / 2		host clock minus CodAlarm clock
+ *     delay  = (T4 - T1) - (T3 - T2)			round trip, host time excluded
+ *
+ * On a time bus the master also broadcasts a t_sync_beacon each minute, carrying its clock at the
+ * start of the frame. Slaves treat it as an exchange without round trip: T1 = T4 = start of the
+ * beacon (slave clock), T2 = T3 = beacon time (master clock), so the delay is zero and the offset
+ * is the beacon time minus the slave clock.
+ *
+ * Timestamps are milliseconds from midnight, local time; differences are taken modulo a day.
+ * Multi-byte fields are little endian.
+ *
+ * This header is shared with the host tools and must not depend on AVR headers.
+ */
+
+/** Frame type of t_sync_request. */
+#define SYNC_REQUEST	0x51
+
+/** Frame type of t_sync_response. */
+#define SYNC_RESPONSE	0x52
+
+/** Frame type of t_sync_beacon. */
+#define SYNC_BEACON		0x42
+
+/** Milliseconds in a day. */
+#define SYNC_DAY_MS		86400000L
+
+/** Sent by CodAlarm to ask for the host time. */
+struct __attribute__((packed)) t_sync_request {
+	/** SYNC_REQUEST. */
+	uint8_t type;
+	/** Request number, echoed in the response. */
+	uint8_t id;
+};
+
+/** Sent by the host in reply to a t_sync_request. */
+struct __attribute__((packed)) t_sync_response {
+	/** SYNC_RESPONSE. */
+	uint8_t type;
+	/** Request number. */
+	uint8_t id;
+	/** T2, request received. */
+	int32_t receive;
+	/** T3, response sent. */
+	int32_t transmit;
+};
+
+/** Broadcast by the bus master. */
+struct __attribute__((packed)) t_sync_beacon {
+	/** SYNC_BEACON. */
+	uint8_t type;
+	/** Master clock when the opening delimiter starts. */
+	int32_t time;
+};
+
+/**
+ * Brings the difference of two timestamps in -12 h .. +12 h.
+ * \param d difference, milliseconds
+ * \return difference modulo a day
+ */
+inline int32_t sync_wrap(int32_t d) {
+	d %= SYNC_DAY_MS;
+	if(d > SYNC_DAY_MS / 2)
+		d -= SYNC_DAY_MS;
+	else if(d < -SYNC_DAY_MS / 2)
+		d += SYNC_DAY_MS;
+	return d;
+}
+
+#endif /* SYNCFORMAT_H_ */
@@ -0,0 +1,153 @@
+#include "Telemetry.h"
+
+#include <util/atomic.h>
+#include <util/crc16.h>
+
+#include "../timers.h"
+#include "../hw/Stack.h"
+
+static_assert(sizeof(t_telemetry) + 2 < 254, "Telemetry: frame too long for a single COBS block");
+
+Telemetry::Telemetry(CodAlarm* _ca, GUI* _gui, EventLog* _eventlog){
+	ca = _ca;
+	gui = _gui;
+	eventlog = _eventlog;
+	step = T_IDLE;
+	enabled = false;
+	countdown = TELEMETRY_PERIOD;
+	position = 0;
+	block_end = 0;
+	crc = 0xFFFF;
+	seq = 0;
+	loops = 0;
+	loop_max = 0;
+	t0_max = 0;
+	t1_max = 0;
+}
+
+void Telemetry::enable(bool on){
+	enabled = on;
+}
+
+bool Telemetry::isEnabled(){
+	return enabled;
+}
+
+bool Telemetry::busy(){
+	return step != T_IDLE;
+}
+
+void Telemetry::tick(){
+	if(countdown > 0)
+		countdown--;
+}
+
+void Telemetry::_snapshot(){
+	t_telemetry* t = (t_telemetry*) frame;
+
+	t->type = TELEMETRY_COUNTERS;
+	t->seq = seq++;
+	t->cpu_khz = F_CPU / 1000;
+	t->t0_div = TIMER0_CFG.div;
+	t->t1_div = TIMER1_CFG.div;
+	t->uptime = eventlog->getMinutes();
+	t->loops = loops;
+	t->loop_max = loop_max;
+	t->redraws = gui->getRedraws();
+	t->updates = ca->display.getUpdates();
+	t->display_bytes = ca->display.getBytes();
+	t->rx_lost = ca->uart.getRxLost();
+	t->tx_lost = ca->uart.getTxLost();
+	t->log_dropped = eventlog->getDropped();
+	t->stack_headroom = stack_scan();
+	loop_max = 0;
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		t->t0_max = t0_max;
+		t->t1_max = t1_max;
+		t0_max = 0;
+		t1_max = 0;
+	}
+}
+
+void Telemetry::poll(){
+	uint8_t budget = TELEMETRY_STEP;
+
+	switch(step){
+	case T_IDLE:
+		if(!enabled)
+			return;
+
+		// Stack headroom, a full scan would take several ms: a few bytes at each pass
+		if(countdown > 0){
+			stack_scan();
+			return;
+		}
+		countdown = TELEMETRY_PERIOD;
+
+		_snapshot();
+		crc = 0xFFFF;
+		position = 0;
+		step = T_CRC;
+		return;
+
+	case T_CRC:
+		while(budget-- && position < sizeof(t_telemetry))
+			crc = _crc_ccitt_update(crc, frame[position++]);
+
+		if(position == sizeof(t_telemetry)){
+			frame[position++] = crc & 0xFF;
+			frame[position++] = crc >> 8;
+			step = T_START;
+		}
+		return;
+
+	default:
+		break;
+	}
+
+	// Encoding: never more than what fits in the transmit buffer
+	if(ca->uart.space() < budget)
+		return;
+
+	while(budget--){
+		switch(step){
+		case T_START:
+			ca->uart.put(0);
+			position = 0;
+			step = T_CODE;
+			continue;
+
+		case T_CODE:
+			// Block up to the next zero, which is replaced by the code byte
+			block_end = position;
+			while(block_end < sizeof(frame) && frame[block_end] != 0)
+				block_end++;
+			ca->uart.put(block_end - position + 1);
+			break;
+
+		case T_DATA:
+			ca->uart.put(frame[position++]);
+			break;
+
+		case T_END:
+			// Frame delimiter
+			ca->uart.put(0);
+			step = T_IDLE;
+			return;
+
+		default:
+			return;
+		}
+
+		if(position < block_end){
+			step = T_DATA;
+		}else if(block_end == sizeof(frame)){
+			step = T_END;
+		}else{
+			// Skip the zero, start the next block
+			position = block_end + 1;
+			step = T_CODE;
+		}
+	}
+}
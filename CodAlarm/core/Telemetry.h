@@ -0,0 +1,162 @@
+#ifndef TELEMETRY_H_
+#define TELEMETRY_H_
+
+#include <stdint.h>
+
+#include "../constants.h"
+#include "CodAlarm.h"
+#include "EventLog.h"
+#include "GUI.h"
+#include "TelemetryFormat.h"
+
+/**
+ * \brief Streams performance counters over the serial port as binary frames.
+ * Every TELEMETRY_PERIOD seconds the counters are copied in a t_telemetry, then the frame is
+ * checksummed and COBS encoded into the serial transmit buffer a few bytes at a time (see
+ * TelemetryFormat.h): each call of poll() handles at most TELEMETRY_STEP bytes, so a frame never
+ * holds the main loop for long. Disabled at power up, enabled from the console.
+ */
+class Telemetry {
+
+public:
+	/**
+	 * Class constructor.
+	 * \param ca Pointer to CodAlarm Object instance.
+	 * \param gui GUI, for the redraw count
+	 * \param eventlog event log, for the uptime and dropped records
+	 * \return
+	 */
+	Telemetry(CodAlarm*, GUI*, EventLog*);
+
+	/**
+	 * Starts or stops streaming. A frame being sent is completed.
+	 * \param on true to start
+	 * \return void
+	 */
+	void enable(bool);
+
+	/**
+	 * Returns whether streaming is enabled.
+	 * \return bool true if enabled
+	 */
+	bool isEnabled();
+
+	/**
+	 * Returns whether a frame is being sent: nothing else may be sent on the serial port.
+	 * \return bool true if sending
+	 */
+	bool busy();
+
+	/**
+	 * Counts time to the next frame. Must be called every second (Timer1 interrupt).
+	 * \return void
+	 */
+	void tick();
+
+	/**
+	 * Prepares and sends frames, a step at a time. Must be called from the main loop.
+	 * \return void
+	 */
+	void poll();
+
+	/**
+	 * Records the duration of a main loop pass.
+	 * \param ticks duration, Timer1 ticks
+	 * \return void
+	 */
+	inline void loop(uint16_t ticks) {
+		loops++;
+		if(ticks > loop_max)
+			loop_max = ticks;
+	}
+
+	/**
+	 * Records the duration of the Timer0 interrupt. Must be called by the interrupt.
+	 * \param ticks duration, Timer0 ticks
+	 * \return void
+	 */
+	inline void isrTimer0(uint8_t ticks) {
+		if(ticks > t0_max)
+			t0_max = ticks;
+	}
+
+	/**
+	 * Records the duration of the Timer1 interrupt. Must be called by the interrupt.
+	 * \param ticks duration, Timer1 ticks
+	 * \return void
+	 */
+	inline void isrTimer1(uint16_t ticks) {
+		if(ticks > t1_max)
+			t1_max = ticks;
+	}
+
+private:
+	/** Pointer the instance of CodAlarm passed in the constructor */
+	CodAlarm* ca;
+
+	/** GUI. */
+	GUI* gui;
+
+	/** Event log. */
+	EventLog* eventlog;
+
+	/** Encoder step. */
+	enum t_step {
+		/** Waiting for the next frame. */
+		T_IDLE,
+		/** Computing the CRC. */
+		T_CRC,
+		/** Sending the leading delimiter. */
+		T_START,
+		/** Sending a COBS code byte. */
+		T_CODE,
+		/** Sending a data byte. */
+		T_DATA,
+		/** Sending the trailing delimiter. */
+		T_END
+	};
+
+	/** Current encoder step. */
+	t_step step;
+
+	/** True if streaming. */
+	bool enabled;
+
+	/** Seconds to the next frame, 0 if due. */
+	volatile uint8_t countdown;
+
+	/** Frame being sent: t_telemetry followed by its CRC. */
+	uint8_t frame[sizeof(t_telemetry) + 2];
+
+	/** Next byte of frame to checksum or send. */
+	uint8_t position;
+
+	/** End of the current COBS block: index of the next zero, or the frame size. */
+	uint8_t block_end;
+
+	/** Running CRC. */
+	uint16_t crc;
+
+	/** Frame number. */
+	uint8_t seq;
+
+	/** Main loop passes. */
+	uint16_t loops;
+
+	/** Longest main loop pass since the last frame. */
+	uint16_t loop_max;
+
+	/** Longest Timer0 interrupt since the last frame. */
+	volatile uint8_t t0_max;
+
+	/** Longest Timer1 interrupt since the last frame. */
+	volatile uint16_t t1_max;
+
+	/**
+	 * Copies the counters in frame and resets the maximums.
+	 * \return void
+	 */
+	void _snapshot();
+};
+
+#endif /* TELEMETRY_H_ */
@@ -0,0 +1,60 @@
+/*! \file */
+
+#ifndef TELEMETRYFORMAT_H_
+#define TELEMETRYFORMAT_H_
+
+#include <stdint.h>
+
+/*
+ * Telemetry frame, a binary frame (see Frame.h) whose payload is a t_telemetry, little endian.
+ *
+ * Totals are 16-bit counters that wrap around: the receiver computes rates from the difference
+ * between two frames. Maximums cover the time since the previous frame. Durations are in timer
+ * ticks: Timer0 and Timer1 tick every t0_div and t1_div CPU cycles at cpu_khz kHz.
+ *
+ * This header is shared with the host decoder (tools/telemetry) and must not depend on AVR headers.
+ */
+
+/** Frame type of t_telemetry. */
+#define TELEMETRY_COUNTERS	0x43
+
+/** Performance counters frame. */
+struct __attribute__((packed)) t_telemetry {
+	/** Frame type, TELEMETRY_COUNTERS. */
+	uint8_t type;
+	/** Frame number, wraps around. */
+	uint8_t seq;
+	/** CPU clock in kHz. */
+	uint16_t cpu_khz;
+	/** Timer0 and Timer1 prescaler divisions. */
+	uint16_t t0_div;
+	uint16_t t1_div;
+	/** Minutes since boot. */
+	uint16_t uptime;
+	/** Main loop passes, total. */
+	uint16_t loops;
+	/** Longest main loop pass, Timer1 ticks. */
+	uint16_t loop_max;
+	/** Longest Timer0 interrupt, Timer0 ticks. */
+	uint8_t t0_max;
+	/** Longest Timer1 interrupt, Timer1 ticks. */
+	uint16_t t1_max;
+	/** Widgets redrawn, total. */
+	uint16_t redraws;
+	/** Display updates that sent something, total. */
+	uint16_t updates;
+	/** Bytes sent to the display, total. */
+	uint16_t display_bytes;
+	/** Serial characters lost on receive and dropped on transmit, total. */
+	uint16_t rx_lost;
+	uint16_t tx_lost;
+	/** Event log records dropped, total. */
+	uint16_t log_dropped;
+	/** Smallest free RAM since power up, bytes. */
+	uint16_t stack_headroom;
+};
+
+/** Largest encoded frame, delimiters included: one COBS code byte per 254 bytes. */
+#define TELEMETRY_FRAME_MAX	(sizeof(t_telemetry) + 2 + 1 + (sizeof(t_telemetry) + 2) / 254 + 2)
+
+#endif /* TELEMETRYFORMAT_H_ */
@@ -0,0 +1,96 @@
+#include "TimeDiscipline.h"
+
+#include "SyncFormat.h"
+
+/** Shortest time between two exchanges to estimate the frequency, seconds. */
+#define FREQ_INTERVAL_MIN	16
+
+TimeDiscipline::TimeDiscipline(uint16_t _ticks, uint16_t _slew_max, int32_t _step_ms, int32_t _delay_max){
+	ticks = _ticks;
+	slew_max = _slew_max;
+	step_ms = _step_ms;
+	delay_max = _delay_max;
+	slew = 0;
+	freq = 0;
+	carry = 0;
+	last = 0;
+	synced = false;
+	step = 0;
+	offset = 0;
+	delay = 0;
+}
+
+t_sync_result TimeDiscipline::update(int32_t t1, int32_t t2, int32_t t3, int32_t t4, uint32_t now){
+	delay = sync_wrap(t4 - t1) - sync_wrap(t3 - t2);
+	if(delay > delay_max)
+		return SYNC_REJECTED;
+
+	offset = (sync_wrap(t2 - t1) + sync_wrap(t3 - t4)) / 2;
+	step = 0;
+
+	if(offset > step_ms || offset < -step_ms){
+		// Too far to slew: step whole seconds, slew the rest. The frequency can't be estimated
+		// across a step
+		step = (offset + (offset > 0 ? 500 : -500)) / 1000;
+		slew = (offset - step * 1000) * ticks / 1000;
+		last = now;
+		synced = true;
+		return SYNC_STEP;
+	}
+
+	int32_t measured = offset * ticks / 1000;
+
+	if(synced && now - last >= FREQ_INTERVAL_MIN){
+		// What wasn't corrected by the last slew accumulated because of the frequency error.
+		// Half of it is applied, to average the timestamp noise
+		int32_t drift = measured - slew;
+		freq += drift * (int32_t) (32768 / (now - last));
+
+		int32_t limit = (int32_t) slew_max * 65536;
+		if(freq > limit)
+			freq = limit;
+		else if(freq < -limit)
+			freq = -limit;
+	}
+
+	last = now;
+
+	// Replaces what is left of the previous correction
+	slew = measured;
+	synced = true;
+	return SYNC_SLEW;
+}
+
+int16_t TimeDiscipline::tick(){
+	// Frequency correction, fraction carried to the next seconds
+	carry += freq;
+	int16_t adjust = carry / 65536;
+	carry -= adjust * 65536L;
+
+	// Offset correction
+	int32_t s = slew;
+	if(s > slew_max)
+		s = slew_max;
+	else if(s < -(int32_t) slew_max)
+		s = -(int32_t) slew_max;
+	slew -= s;
+
+	return adjust + s;
+}
+
+int32_t TimeDiscipline::getStep(){
+	return step;
+}
+
+int32_t TimeDiscipline::getOffset(){
+	return offset;
+}
+
+int32_t TimeDiscipline::getDelay(){
+	return delay;
+}
+
+int16_t TimeDiscipline::getPpm(){
+	// 1 tick/s is 1e6 / ticks ppm, 1e6 / 65536 = 15625 / 1024
+	return freq * 16 / ticks * 15625 / 16384;
+}
@@ -0,0 +1,116 @@
+#ifndef TIMEDISCIPLINE_H_
+#define TIMEDISCIPLINE_H_
+
+#include <stdint.h>
+
+/** Result of TimeDiscipline::update(). */
+enum t_sync_result {
+	/** Round trip too long, exchange discarded. */
+	SYNC_REJECTED,
+	/** Offset small: corrected by slewing. */
+	SYNC_SLEW,
+	/** Offset large: the clock must be stepped by getStep() seconds, the rest is slewed. */
+	SYNC_STEP
+};
+
+/**
+ * \brief Clock discipline from NTP-like exchanges (see SyncFormat.h).
+ * The clock is a count of seconds, each lasting a number of ticks of a timer. Offsets are
+ * corrected by slewing: for a while each second is made shorter or longer by up to slew_max
+ * ticks, so time never jumps or runs backwards. Only offsets larger than step_ms are stepped,
+ * by whole seconds. The residual offset measured at each exchange is also used to estimate the
+ * frequency error of the timer, which is then corrected continuously.
+ *
+ * Doesn't depend on the hardware, so it can also be built on the host (see tools/timesync).
+ */
+class TimeDiscipline {
+
+public:
+	/**
+	 * Class constructor.
+	 * \param ticks timer ticks per second, nominal
+	 * \param slew_max largest correction of a single second, in ticks
+	 * \param step_ms offsets larger than this are stepped, milliseconds
+	 * \param delay_max exchanges with a longer round trip are rejected, milliseconds
+	 * \return
+	 */
+	TimeDiscipline(uint16_t, uint16_t, int32_t, int32_t);
+
+	/**
+	 * Processes an exchange.
+	 * \param t1 request sent, local clock, ms from midnight
+	 * \param t2 request received, reference clock
+	 * \param t3 response sent, reference clock
+	 * \param t4 response received, local clock
+	 * \param now seconds since boot, to measure the time between exchanges
+	 * \return result
+	 */
+	t_sync_result update(int32_t, int32_t, int32_t, int32_t, uint32_t);
+
+	/**
+	 * Returns the correction of the next second. Must be called once per second.
+	 * \return ticks to remove from the next second, negative to add
+	 */
+	int16_t tick();
+
+	/**
+	 * Returns the step requested by the last update().
+	 * \return seconds to add to the clock
+	 */
+	int32_t getStep();
+
+	/**
+	 * Returns the offset measured by the last accepted exchange.
+	 * \return reference minus local clock, milliseconds
+	 */
+	int32_t getOffset();
+
+	/**
+	 * Returns the round trip of the last exchange.
+	 * \return milliseconds
+	 */
+	int32_t getDelay();
+
+	/**
+	 * Returns the frequency correction.
+	 * \return parts per million, positive if the local clock was slow
+	 */
+	int16_t getPpm();
+
+private:
+	/** Ticks per second. */
+	uint16_t ticks;
+
+	/** Largest slew per second, ticks. */
+	uint16_t slew_max;
+
+	/** Step threshold, milliseconds. */
+	int32_t step_ms;
+
+	/** Round trip limit, milliseconds. */
+	int32_t delay_max;
+
+	/** Offset still to be slewed, ticks. */
+	int32_t slew;
+
+	/** Frequency correction, ticks per second, 16.16 fixed point. */
+	int32_t freq;
+
+	/** Fraction of tick carried by the frequency correction, 16.16 fixed point. */
+	int32_t carry;
+
+	/** Seconds since boot of the last accepted exchange. */
+	uint32_t last;
+
+	/** True once an exchange was accepted. */
+	bool synced;
+
+	/** Last step, seconds. */
+	int32_t step;
+
+	/** Last offset and delay, milliseconds. */
+	int32_t offset;
+	int32_t delay;
+};
+
+#endif /* TIMEDISCIPLINE_H_ */
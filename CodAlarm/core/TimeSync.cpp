@@ -0,0 +1,232 @@
+#include "TimeSync.h"
+
+#include <string.h>
+#include <util/atomic.h>
+
+#include "Frame.h"
+#include "../hal/Hal.h"
+
+/** Transmission time of a byte on the serial line (10 bits), microseconds. */
+#define SYNC_BYTE_US	(10000000UL / UART_BAUD)
+
+/** Largest slew of a second, Timer1 ticks. */
+#define SYNC_SLEW_TICKS	((TIMER1_CMP + 1) * (uint32_t) SYNC_SLEW_PPM / 1000000UL)
+
+static_assert(SYNC_SLEW_TICKS > 0, "TimeSync: SYNC_SLEW_PPM is less than a Timer1 tick");
+static_assert(SYNC_FRAME_MAX <= UART_RX_BUFFER, "TimeSync: UART_RX_BUFFER can't hold a response");
+
+TimeSync::TimeSync(CodAlarm* _ca, Checkpoint* _checkpoint, EventLog* _eventlog)
+	: discipline(TIMER1_CMP + 1, SYNC_SLEW_TICKS, SYNC_STEP_MS, SYNC_DELAY_MAX) {
+	ca = _ca;
+	checkpoint = _checkpoint;
+	eventlog = _eventlog;
+	enabled = false;
+	step = S_IDLE;
+	countdown = 0;
+	uptime = 0;
+	id = 0;
+	count = 0;
+	beacon_minute = 0xFFFF;
+}
+
+void TimeSync::enable(bool on){
+	enabled = on;
+	countdown = 0;
+}
+
+bool TimeSync::isEnabled(){
+	return enabled;
+}
+
+bool TimeSync::busy(){
+	return step == S_SENDING || step == S_BEACON;
+}
+
+void TimeSync::tick(){
+	// The compare match just reset Timer1: the new top applies to this second
+	hal_timer1_setTop(TIMER1_CMP - discipline.tick());
+
+	uptime++;
+	if(countdown > 0)
+		countdown--;
+}
+
+void TimeSync::_stamp(t_stamp* stamp){
+	stamp->seconds = ca->clock.getValue();
+	stamp->count = hal_timer1_count();
+	stamp->top = hal_timer1_top();
+
+	// Second elapsed but not counted yet: the Timer1 interrupt is pending
+	if(hal_timer1_pending() && stamp->count < stamp->top / 2){
+		stamp->seconds++;
+		if(stamp->seconds >= D_SEC)
+			stamp->seconds = 0;
+	}
+}
+
+int32_t TimeSync::_ms(const t_stamp* stamp){
+	return stamp->seconds * 1000 + (uint32_t) stamp->count * 1000 / ((uint32_t) stamp->top + 1);
+}
+
+void TimeSync::sent(){
+	if(step == S_BEACON){
+		step = S_IDLE;
+		return;
+	}
+
+	_stamp(&stamp_sent);
+	step = S_WAITING;
+	countdown = SYNC_TIMEOUT;
+}
+
+void TimeSync::delimiter(){
+	stamp_opening = stamp_delimiter;
+	_stamp(&stamp_delimiter);
+}
+
+void TimeSync::poll(){
+	if(step == S_WAITING && countdown == 0){
+		// No response
+		step = S_IDLE;
+		countdown = SYNC_PERIOD;
+	}
+
+	if(ca->bus == BUS_MASTER)
+		_beacon();
+
+	if(!enabled || ca->bus == BUS_SLAVE || step != S_IDLE || countdown > 0)
+		return;
+
+	// The end of the request is the end of the transmission: nothing else may be queued
+	if(!ca->uart.idle())
+		return;
+
+	t_sync_request request = { SYNC_REQUEST, ++id };
+	uint8_t frame[sizeof(request) + 5];
+	uint8_t n = frame_encode((const uint8_t*) &request, sizeof(request), frame);
+
+	step = S_SENDING;
+	for(uint8_t i=0; i<n; i++)
+		ca->uart.put(frame[i]);
+	ca->uart.watchSent();
+}
+
+void TimeSync::_beacon(){
+	long value;
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		value = ca->clock.getValue();
+	}
+
+	uint16_t minute = value / M_SEC;
+	if(value % M_SEC < BUS_SECOND || minute == beacon_minute || step != S_IDLE)
+		return;
+
+	// The beacon time is the start of the transmission: nothing else may be queued
+	if(!ca->uart.idle())
+		return;
+
+	t_sync_beacon beacon;
+	t_stamp stamp;
+	uint8_t frame[sizeof(beacon) + 5];
+
+	beacon_minute = minute;
+	step = S_BEACON;
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		_stamp(&stamp);
+		ca->uart.drive();
+		ca->uart.put(0);
+	}
+
+	// The opening delimiter is already on the line: encode the rest while it is sent
+	beacon.type = SYNC_BEACON;
+	beacon.time = _ms(&stamp);
+	uint8_t n = frame_encode((const uint8_t*) &beacon, sizeof(beacon), frame);
+
+	for(uint8_t i=1; i<n; i++)
+		ca->uart.put(frame[i]);
+	ca->uart.watchSent();
+}
+
+void TimeSync::receive(const uint8_t* frame, uint8_t n){
+	t_stamp stamp, opening;
+	uint32_t now;
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		stamp = stamp_delimiter;
+		opening = stamp_opening;
+		now = uptime;
+	}
+
+	if(n > SYNC_FRAME_MAX)
+		return;
+
+	uint8_t payload[SYNC_FRAME_MAX];
+	int16_t size = frame_decode(frame, n, payload);
+
+	if(size == sizeof(t_sync_beacon) && payload[0] == SYNC_BEACON){
+		// The master also hears its own beacons
+		if(ca->bus != BUS_SLAVE)
+			return;
+
+		t_sync_beacon beacon;
+		memcpy(&beacon, payload, sizeof(beacon));
+
+		// The opening delimiter ends one byte after the start of the beacon
+		int32_t t = _ms(&opening) - (int32_t) (SYNC_BYTE_US / 1000);
+		_apply(discipline.update(t, beacon.time, beacon.time, t, now));
+		return;
+	}
+
+	t_sync_response response;
+	if(step != S_WAITING || size != sizeof(response))
+		return;
+
+	memcpy(&response, payload, sizeof(response));
+	if(response.type != SYNC_RESPONSE || response.id != id)
+		return;
+
+	step = S_IDLE;
+	countdown = SYNC_PERIOD;
+
+	// T4: the delimiter ends the frame, go back to its start
+	int32_t t1 = _ms(&stamp_sent);
+	int32_t t4 = _ms(&stamp) - (int32_t) ((n + 2) * SYNC_BYTE_US / 1000);
+
+	_apply(discipline.update(t1, response.receive, response.transmit, t4, now));
+}
+
+void TimeSync::_apply(t_sync_result result){
+	switch(result){
+	case SYNC_REJECTED:
+		return;
+
+	case SYNC_STEP:
+		_step(discipline.getStep());
+		break;
+
+	case SYNC_SLEW:
+		break;
+	}
+
+	count++;
+	ca->stale = false;
+}
+
+void TimeSync::_step(int32_t seconds){
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		long value = (ca->clock.getValue() + seconds) % D_SEC;
+		ca->clock.setValue(value < 0 ? value + D_SEC : value);
+	}
+
+	// Same as setting the clock with the buttons
+	checkpoint->request();
+	eventlog->logTime(LOG_TIME_SET);
+}
+
+TimeDiscipline* TimeSync::getDiscipline(){
+	return &discipline;
+}
+
+uint16_t TimeSync::getCount(){
+	return count;
+}
@@ -0,0 +1,206 @@
+#ifndef TIMESYNC_H_
+#define TIMESYNC_H_
+
+#include <stdint.h>
+
+#include "../constants.h"
+#include "CodAlarm.h"
+#include "Checkpoint.h"
+#include "EventLog.h"
+#include "SyncFormat.h"
+#include "TimeDiscipline.h"
+
+/** Largest encoded frame received by TimeSync, delimiters excluded. */
+#define SYNC_FRAME_MAX	(sizeof(t_sync_response) + 3)
+
+/**
+ * \brief Synchronises the clock with a host over the serial port.
+ * Every SYNC_PERIOD seconds a t_sync_request is sent and the host answers with its timestamps
+ * (see SyncFormat.h). The local timestamps are taken in the USART interrupts from the clock
+ * seconds and Timer1, so they don't depend on when the main loop runs. The clock is corrected by
+ * TimeDiscipline through the length of each second (OCR1A): it is only stepped for offsets above
+ * SYNC_STEP_MS. Disabled at power up, enabled from the console (the host daemon does it).
+ *
+ * On a time bus (CodAlarm::bus) the master broadcasts a t_sync_beacon at BUS_SECOND of every
+ * minute, 10 bytes on the line, and the slaves discipline their clock to it the same way. Only the
+ * master drives the bus and only once a minute, so beacons can't collide; slaves never send
+ * requests to a host. The master follows the host if requests are enabled, its crystal otherwise.
+ */
+class TimeSync {
+
+public:
+	/**
+	 * Class constructor.
+	 * \param ca Pointer to CodAlarm Object instance.
+	 * \param checkpoint clock checkpoint, requested when the clock is stepped
+	 * \param eventlog event log, to log clock steps
+	 * \return
+	 */
+	TimeSync(CodAlarm*, Checkpoint*, EventLog*);
+
+	/**
+	 * Starts or stops the requests. The frequency correction stays.
+	 * \param on true to start
+	 * \return void
+	 */
+	void enable(bool);
+
+	/**
+	 * Returns whether requests are enabled.
+	 * \return bool true if enabled
+	 */
+	bool isEnabled();
+
+	/**
+	 * Returns whether a request or a beacon is being sent: nothing else may be sent on the serial
+	 * port until its end is timestamped.
+	 * \return bool true if sending
+	 */
+	bool busy();
+
+	/**
+	 * Sets the length of the next second and counts time. Must be called every second, first
+	 * thing in the Timer1 interrupt.
+	 * \return void
+	 */
+	void tick();
+
+	/**
+	 * Sends requests and beacons when due. Must be called from the main loop.
+	 * \return void
+	 */
+	void poll();
+
+	/**
+	 * Passes a frame received on the serial port.
+	 * \param frame encoded frame, delimiters excluded
+	 * \param n size
+	 * \return void
+	 */
+	void receive(const uint8_t*, uint8_t);
+
+	/**
+	 * Timestamps the end of the request or ends the beacon. Must be called by the USART_TX
+	 * interrupt.
+	 * \return void
+	 */
+	void sent();
+
+	/**
+	 * Timestamps a frame delimiter. Must be called by the USART_RX interrupt for each zero byte.
+	 * \return void
+	 */
+	void delimiter();
+
+	/**
+	 * Returns the clock discipline, for its offset, delay and frequency.
+	 * \return discipline
+	 */
+	TimeDiscipline* getDiscipline();
+
+	/**
+	 * Returns the number of accepted exchanges and beacons since power up.
+	 * \return count
+	 */
+	uint16_t getCount();
+
+private:
+	/** Timestamp taken in an interrupt. */
+	struct t_stamp {
+		/** Clock value, seconds. */
+		long seconds;
+		/** Timer1 count and top in that second. */
+		uint16_t count;
+		uint16_t top;
+	};
+
+	/** Exchange step. */
+	enum t_step {
+		/** Waiting for the next request. */
+		S_IDLE,
+		/** Request queued, waiting for its end. */
+		S_SENDING,
+		/** Beacon queued, waiting for its end. */
+		S_BEACON,
+		/** Waiting for the response. */
+		S_WAITING
+	};
+
+	/** Pointer the instance of CodAlarm passed in the constructor */
+	CodAlarm* ca;
+
+	/** Clock checkpoint. */
+	Checkpoint* checkpoint;
+
+	/** Event log. */
+	EventLog* eventlog;
+
+	/** Clock discipline. */
+	TimeDiscipline discipline;
+
+	/** True if requests are enabled. */
+	bool enabled;
+
+	/** Current exchange step. */
+	volatile t_step step;
+
+	/** Seconds to the next request, or to the response timeout. */
+	volatile uint8_t countdown;
+
+	/** Seconds since power up. */
+	volatile uint32_t uptime;
+
+	/** Number of the last request. */
+	uint8_t id;
+
+	/** Accepted exchanges. */
+	uint16_t count;
+
+	/** End of the request (T1). */
+	t_stamp stamp_sent;
+
+	/** Last frame delimiter received. */
+	t_stamp stamp_delimiter;
+
+	/** Delimiter received before the last one: the start of the last frame. */
+	t_stamp stamp_opening;
+
+	/** Minute of the last beacon sent, from midnight. */
+	uint16_t beacon_minute;
+
+	/**
+	 * Reads the clock and Timer1. Must be called with interrupts disabled.
+	 * \param stamp destination
+	 * \return void
+	 */
+	void _stamp(t_stamp*);
+
+	/**
+	 * Converts a timestamp.
+	 * \param stamp timestamp
+	 * \return milliseconds from midnight
+	 */
+	static int32_t _ms(const t_stamp*);
+
+	/**
+	 * Sends a beacon if the master is due to.
+	 * \return void
+	 */
+	void _beacon();
+
+	/**
+	 * Applies the result of an exchange or a beacon to the clock.
+	 * \param result result of TimeDiscipline::update()
+	 * \return void
+	 */
+	void _apply(t_sync_result);
+
+	/**
+	 * Steps the clock.
+	 * \param seconds seconds to add
+	 * \return void
+	 */
+	void _step(int32_t);
+};
+
+#endif /* TIMESYNC_H_ */
@@ -0,0 +1,32 @@
+/*! \file */
+
+#ifndef HAL_H_
+#define HAL_H_
+
+#include <stdint.h>
+
+/*
+ * Hardware abstraction layer: the hardware accesses of the firmware logic that a host build must
+ * replace. Each platform implements them in its own header, AVR with inline register accesses
+ * (no cost over the plain registers), the host with plain memory that host programs read and
+ * drive (see host/HalHost.h).
+ *
+ * GPIO        Pin<> of hw/Pin.h, over the port registers
+ * SPI         hal_spi_init(), hal_spi_write()
+ * USART SPI   hal_usart_spi_init(), hal_usart_spi_load(), hal_usart_spi_sent(), USART0 in master
+ *             SPI mode; its interrupt enables stay in UCSR0B
+ * Idle        hal_idle(), in the loops waiting for an interrupt handler
+ * Timer1      hal_timer1_count(), hal_timer1_top(), hal_timer1_setTop(), hal_timer1_pending()
+ * Delay       hal_delay_us(), hal_delay_ms(), compile time constants only
+ *
+ * On the host the AVR headers used by the firmware (<avr/io.h>, <avr/pgmspace.h>, ...) are
+ * replaced by those in host/: registers are variables, flash is RAM and interrupts don't exist.
+ */
+
+#ifdef __AVR__
+#include "avr/HalAvr.h"
+#else
+#include "host/HalHost.h"
+#endif
+
+#endif /* HAL_H_ */
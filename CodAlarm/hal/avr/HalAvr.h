@@ -0,0 +1,120 @@
+/*! \file */
+
+#ifndef HALAVR_H_
+#define HALAVR_H_
+
+#include <avr/io.h>
+#include <stdint.h>
+#include <util/atomic.h>
+#include <util/delay.h>
+
+/*
+ * AVR implementation of the HAL (see Hal.h), ATmega328P.
+ */
+
+/**
+ * Configures the SPI as master, clock fclk/16. SS, MOSI and SCK become outputs.
+ * \return void
+ */
+static inline void hal_spi_init() {
+	DDRB |= (1<<DDB3) | (1<<DDB2) | (1<<DDB5);	// Set SS, MOSI and SCK output, keep the others
+	SPCR = (1<<SPE) | (1<<MSTR) | (1<<SPR0);		// Enable SPI, Master, set clock rate fclk/16
+}
+
+/**
+ * Sends a byte and waits for the end of the transfer.
+ * \param c byte
+ * \return void
+ */
+static inline void hal_spi_write(uint8_t c) {
+	SPDR = c;
+	while(!(SPSR & (1<<SPIF)));
+}
+
+/**
+ * Configures USART0 in master SPI mode, SPI mode 0, most significant bit first, at
+ * F_CPU / (2 * (ubrr + 1)). XCK (PD4) becomes an output; only the transmitter is enabled.
+ * \param ubrr baud rate register
+ * \return void
+ */
+static inline void hal_usart_spi_init(uint16_t ubrr) {
+	UBRR0 = 0;
+	DDRD |= (1<<DDD4);								// XCK output: master
+	UCSR0C = (1<<UMSEL01) | (1<<UMSEL00);			// Master SPI, MSB first, mode 0
+	UCSR0B = (1<<TXEN0);
+	UBRR0 = ubrr;									// Baud rate once the transmitter is on
+}
+
+/**
+ * Loads a byte into the transmit buffer, which must be empty (UDRE0), and clears the transmit
+ * complete flag: it is then set when this byte and the ones before have left.
+ * \param c byte
+ * \return void
+ */
+static inline void hal_usart_spi_load(uint8_t c) {
+	UCSR0A = (1<<TXC0);
+	UDR0 = c;
+}
+
+/**
+ * Returns whether everything loaded has left the shift register.
+ * \return bool true if sent
+ */
+static inline bool hal_usart_spi_sent() {
+	return UCSR0A & (1<<TXC0);
+}
+
+/**
+ * Reads the Timer1 count. 16-bit reads share a temporary register with the interrupts reading
+ * Timer1, so interrupts are disabled while reading.
+ * \return count
+ */
+static inline uint16_t hal_timer1_count() {
+	uint16_t count;
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		count = TCNT1;
+	}
+	return count;
+}
+
+/**
+ * Reads the Timer1 top (OCR1A).
+ * \return top
+ */
+static inline uint16_t hal_timer1_top() {
+	uint16_t top;
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		top = OCR1A;
+	}
+	return top;
+}
+
+/**
+ * Sets the Timer1 top (OCR1A). Must be called with interrupts disabled, as in the Timer1 interrupt.
+ * \param top top
+ * \return void
+ */
+static inline void hal_timer1_setTop(uint16_t top) {
+	OCR1A = top;
+}
+
+/**
+ * Returns whether the Timer1 compare interrupt is pending.
+ * \return bool true if pending
+ */
+static inline bool hal_timer1_pending() {
+	return TIFR1 & (1 << OCF1A);
+}
+
+/**
+ * Waits for an interrupt handler to make progress: nothing to do, interrupts run by themselves.
+ * \return void
+ */
+static inline void hal_idle() {
+}
+
+/** Busy waits, util/delay.h: the duration must be a compile time constant. */
+#define hal_delay_us(us)	_delay_us(us)
+#define hal_delay_ms(ms)	_delay_ms(ms)
+
+#endif /* HALAVR_H_ */
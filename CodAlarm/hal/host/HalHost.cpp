@@ -0,0 +1,42 @@
+#include "HalHost.h"
+
+#include <avr/eeprom.h>
+#include <avr/io.h>
+
+#include "../../constants.h"
+#include "../../timers.h"
+
+// Registers of <avr/io.h>
+volatile uint8_t PINB, DDRB, PORTB;
+volatile uint8_t PINC, DDRC, PORTC;
+volatile uint8_t PIND, DDRD, PORTD;
+volatile uint8_t TCCR0A, TCCR0B, TCNT0, TIMSK0, TIFR0;
+volatile uint8_t TCCR1A, TCCR1B, TIMSK1, TIFR1;
+volatile uint16_t TCNT1, OCR1A;
+volatile uint8_t TCCR2A, TCCR2B, TCNT2, OCR2A, TIMSK2, TIFR2;
+volatile uint8_t SPCR, SPSR, SPDR;
+volatile uint8_t UCSR0A, UCSR0B, UCSR0C, UDR0;
+volatile uint16_t UBRR0;
+volatile uint8_t EECR, EEDR;
+volatile uint16_t EEAR;
+volatile uint8_t MCUSR, SREG;
+volatile uint16_t SP = RAMEND;
+
+// Erased EEPROM
+struct t_erased {
+	t_erased() {
+		for(uint16_t i = 0; i <= E2END; i++)
+			host_eeprom[i] = 0xFF;
+	}
+};
+
+uint8_t host_eeprom[E2END + 1];
+static t_erased erased;
+
+void (*host_spi_hook)(uint8_t) = 0;
+void (*host_idle_hook)(void) = 0;
+bool host_usart_spi_sent = false;
+uint16_t host_timer1_count = 0;
+uint16_t host_timer1_top = TIMER1_CMP;
+bool host_timer1_pending = false;
+double host_delay_us = 0;
@@ -0,0 +1,84 @@
+/*! \file */
+
+#ifndef HALHOST_H_
+#define HALHOST_H_
+
+#include <stdint.h>
+
+/*
+ * Host implementation of the HAL (see Hal.h), for builds of the firmware logic on a workstation.
+ *
+ * Nothing runs by itself: the host program plays the hardware through the variables below, sets
+ * the Timer1 count, calls the interrupt handlers of the firmware classes, and reads what was
+ * sent on the SPI bus.
+ */
+
+/** Called with each byte sent on the SPI bus, if set. */
+extern void (*host_spi_hook)(uint8_t);
+
+/** Timer1 count, top and pending compare interrupt, as the host program sets them. */
+extern uint16_t host_timer1_count;
+extern uint16_t host_timer1_top;
+extern bool host_timer1_pending;
+
+/** USART SPI: false from a byte loaded until the host program sets it, the byte having left. */
+extern bool host_usart_spi_sent;
+
+/** Called by hal_idle(), if set: the host program runs the interrupt handlers waited for. */
+extern void (*host_idle_hook)(void);
+
+/** Total time of the busy waits so far, microseconds. */
+extern double host_delay_us;
+
+static inline void hal_spi_init() {
+}
+
+static inline void hal_spi_write(uint8_t c) {
+	if(host_spi_hook)
+		host_spi_hook(c);
+}
+
+/** The USART SPI bytes go to host_spi_hook too. */
+static inline void hal_usart_spi_init(uint16_t) {
+}
+
+static inline void hal_usart_spi_load(uint8_t c) {
+	host_usart_spi_sent = false;
+	if(host_spi_hook)
+		host_spi_hook(c);
+}
+
+static inline bool hal_usart_spi_sent() {
+	return host_usart_spi_sent;
+}
+
+static inline void hal_idle() {
+	if(host_idle_hook)
+		host_idle_hook();
+}
+
+static inline uint16_t hal_timer1_count() {
+	return host_timer1_count;
+}
+
+static inline uint16_t hal_timer1_top() {
+	return host_timer1_top;
+}
+
+static inline void hal_timer1_setTop(uint16_t top) {
+	host_timer1_top = top;
+}
+
+static inline bool hal_timer1_pending() {
+	return host_timer1_pending;
+}
+
+static inline void hal_delay_us(double us) {
+	host_delay_us += us;
+}
+
+static inline void hal_delay_ms(double ms) {
+	host_delay_us += ms * 1000;
+}
+
+#endif /* HALHOST_H_ */
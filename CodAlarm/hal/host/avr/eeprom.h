@@ -0,0 +1,21 @@
+/*
+ * Host replacement of <avr/eeprom.h> (see ../Hal.h): the EEPROM is host_eeprom, erased (0xFF) at
+ * start. Eeprom::ready() writes through the registers, which are not emulated.
+ */
+
+#ifndef HOST_AVR_EEPROM_H_
+#define HOST_AVR_EEPROM_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "io.h"
+
+extern uint8_t host_eeprom[E2END + 1];
+
+static inline void eeprom_read_block(void* dst, const void* src, size_t n) {
+	memcpy(dst, host_eeprom + (uintptr_t) src, n);
+}
+
+#endif /* HOST_AVR_EEPROM_H_ */
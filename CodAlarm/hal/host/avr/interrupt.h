@@ -0,0 +1,13 @@
+/*
+ * Host replacement of <avr/interrupt.h> (see ../Hal.h): interrupts don't exist, handlers are
+ * ordinary functions the host program calls.
+ */
+
+#ifndef HOST_AVR_INTERRUPT_H_
+#define HOST_AVR_INTERRUPT_H_
+
+#define ISR(vector)		extern "C" void vector(void)
+#define sei()
+#define cli()
+
+#endif /* HOST_AVR_INTERRUPT_H_ */
@@ -0,0 +1,83 @@
+/*
+ * Host replacement of <avr/io.h> (see ../Hal.h): the ATmega328P registers used by the firmware,
+ * as variables defined in HalHost.cpp. Writing them has no side effect.
+ */
+
+#ifndef HOST_AVR_IO_H_
+#define HOST_AVR_IO_H_
+
+#include <stdint.h>
+
+// Ports
+extern volatile uint8_t PINB, DDRB, PORTB;
+extern volatile uint8_t PINC, DDRC, PORTC;
+extern volatile uint8_t PIND, DDRD, PORTD;
+
+// Timers
+extern volatile uint8_t TCCR0A, TCCR0B, TCNT0, TIMSK0, TIFR0;
+extern volatile uint8_t TCCR1A, TCCR1B, TIMSK1, TIFR1;
+extern volatile uint16_t TCNT1, OCR1A;
+extern volatile uint8_t TCCR2A, TCCR2B, TCNT2, OCR2A, TIMSK2, TIFR2;
+
+// SPI
+extern volatile uint8_t SPCR, SPSR, SPDR;
+
+// USART0
+extern volatile uint8_t UCSR0A, UCSR0B, UCSR0C, UDR0;
+extern volatile uint16_t UBRR0;
+
+// EEPROM
+extern volatile uint8_t EECR, EEDR;
+extern volatile uint16_t EEAR;
+
+// CPU
+extern volatile uint8_t MCUSR, SREG;
+extern volatile uint16_t SP;
+
+#define RAMEND		0x8FF
+#define E2END		0x3FF
+
+#define DDB2		2
+#define DDB3		3
+#define DDB5		5
+#define DDD4		4
+
+#define TOIE0		0
+#define TOV0		0
+#define OCIE1A		1
+#define OCF1A		1
+#define OCIE2A		1
+#define WGM12		3
+#define WGM21		1
+
+#define SPR0		0
+#define MSTR		4
+#define SPE			6
+#define SPIF		7
+
+#define U2X0		1
+#define DOR0		3
+#define UDRE0		5
+#define TXC0		6
+#define RXC0		7
+#define UCSZ00		1
+#define UCSZ01		2
+#define TXEN0		3
+#define RXEN0		4
+#define UDRIE0		5
+#define TXCIE0		6
+#define RXCIE0		7
+#define UMSEL00		6
+#define UMSEL01		7
+
+#define EERE		0
+#define EEPE		1
+#define EEMPE		2
+#define EERIE		3
+
+#define PORF		0
+#define EXTRF		1
+#define BORF		2
+#define WDRF		3
+
+#endif /* HOST_AVR_IO_H_ */
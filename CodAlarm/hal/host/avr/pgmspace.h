@@ -0,0 +1,19 @@
+/*
+ * Host replacement of <avr/pgmspace.h> (see ../Hal.h): flash is ordinary memory.
+ */
+
+#ifndef HOST_AVR_PGMSPACE_H_
+#define HOST_AVR_PGMSPACE_H_
+
+#include <stdint.h>
+#include <string.h>
+
+#define PROGMEM
+#define PSTR(s)				(s)
+#define pgm_read_byte(a)	(*(const uint8_t*) (a))
+#define pgm_read_word(a)	(*(const uint16_t*) (a))
+#define pgm_read_ptr(a)		(*(void* const*) (a))
+#define strcmp_P			strcmp
+#define memcpy_P			memcpy
+
+#endif /* HOST_AVR_PGMSPACE_H_ */
@@ -0,0 +1,13 @@
+/*
+ * Host replacement of <util/atomic.h> (see ../Hal.h): nothing interrupts the host program, the
+ * block runs once.
+ */
+
+#ifndef HOST_UTIL_ATOMIC_H_
+#define HOST_UTIL_ATOMIC_H_
+
+#define ATOMIC_BLOCK(type)		for(bool atomic_once = true; atomic_once; atomic_once = false)
+#define ATOMIC_RESTORESTATE
+#define ATOMIC_FORCEON
+
+#endif /* HOST_UTIL_ATOMIC_H_ */
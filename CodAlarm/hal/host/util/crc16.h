@@ -0,0 +1,25 @@
+/*
+ * Host replacement of <util/crc16.h> (see ../Hal.h): the same CRCs, in C.
+ */
+
+#ifndef HOST_UTIL_CRC16_H_
+#define HOST_UTIL_CRC16_H_
+
+#include <stdint.h>
+
+/** CRC-CCITT, reflected (polynomial 0x8408), as avr-libc. */
+static inline uint16_t _crc_ccitt_update(uint16_t crc, uint8_t data) {
+	data ^= crc & 0xFF;
+	data ^= data << 4;
+	return (((uint16_t) data << 8) | (crc >> 8)) ^ (uint8_t) (data >> 4) ^ ((uint16_t) data << 3);
+}
+
+/** CRC-8, polynomial 0x07, as avr-libc. */
+static inline uint8_t _crc8_ccitt_update(uint8_t crc, uint8_t data) {
+	crc ^= data;
+	for(uint8_t i = 0; i < 8; i++)
+		crc = (crc & 0x80) ? (uint8_t) ((crc << 1) ^ 0x07) : (uint8_t) (crc << 1);
+	return crc;
+}
+
+#endif /* HOST_UTIL_CRC16_H_ */
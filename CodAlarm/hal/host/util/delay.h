@@ -0,0 +1,13 @@
+/*
+ * Host replacement of <util/delay.h> (see ../Hal.h): busy waits only add to host_delay_us.
+ */
+
+#ifndef HOST_UTIL_DELAY_H_
+#define HOST_UTIL_DELAY_H_
+
+#include "../HalHost.h"
+
+#define _delay_us(us)	hal_delay_us(us)
+#define _delay_ms(ms)	hal_delay_ms(ms)
+
+#endif /* HOST_UTIL_DELAY_H_ */
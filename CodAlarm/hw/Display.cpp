@@ -1,91 +1,119 @@
 #include "Display.h"
 
-void Display::init() {
+#include "Profile.h"
+#include "Trace.h"
 
-    // Configure SPI
-    DDRB = (1<<DDB3)| (1<<DDB2) | (1<<DDB5); 	// Set SS, MOSI and SCK output, all others input
-    SPCR = (1<<SPE) | (1<<MSTR) | (1<<SPR0); 	// Enable SPI, Master, set clock rate fclk/16
+template<class Controller, class Link>
+void DisplayDriver<Controller, Link>::init() {
+
+    // Configure the link and A0
+    Link::init();
+
+    // Statistics
+    updates = 0;
+    bytes = 0;
 
     // Configure direction
-    DDR(PORT_DISPLAY_A0)	= SET_BIT(DDR(PORT_DISPLAY_A0), LINE_DISPLAY_A0);
-    DDR(PORT_DISPLAY_RESET)	= SET_BIT(DDR(PORT_DISPLAY_RESET), LINE_DISPLAY_RESET);
+    PinDisplayReset::output();
 
     reset();
+
+    // Buffer starts empty, the whole display is sent at the first update
+    dirty_x0 = 0xFF;
+    dirty_x1 = 0;
+    clear();
 }
 
-void Display::_send(char c) {
+template<class Controller, class Link>
+void DisplayDriver<Controller, Link>::_reset() {
+    PinDisplayReset::set();
+    hal_delay_us(30);
+    PinDisplayReset::clear();
+    hal_delay_us(30);		// Just to be safe...
+}
 
-    SPDR = c;
+template<class Controller, class Link>
+void DisplayDriver<Controller, Link>::reset() {
 
-    // Wait completion
-    while(!(SPSR & (1<<SPIF)));
-}
+    // Bytes still queued would reach the controller after its reset
+    Link::flush();
+    _reset();
 
-void Display::_sendCommand(char data) {
-    PORT(PORT_DISPLAY_A0) = SET_BIT(PORT(PORT_DISPLAY_A0), LINE_DISPLAY_A0);
-    _delay_us(15);
-    _send(data);
+	// Configure display
+    Controller::template configure<Link>();
 }
 
-void Display::_sendData(char data) {
-    PORT(PORT_DISPLAY_A0) = UNSET_BIT(PORT(PORT_DISPLAY_A0), LINE_DISPLAY_A0);
-    _delay_us(15);
-    _send(data);
-}
+template<class Controller, class Link>
+void DisplayDriver<Controller, Link>::update() {
+    // Nothing changed
+    if(dirty_x0 > dirty_x1)
+        return;
 
-void Display::_reset() {
-    PORT(PORT_DISPLAY_RESET) = SET_BIT(PORT(PORT_DISPLAY_RESET), LINE_DISPLAY_RESET);
-    _delay_us(30);
-    PORT(PORT_DISPLAY_RESET) = UNSET_BIT(PORT(PORT_DISPLAY_RESET), LINE_DISPLAY_RESET);
-    _delay_us(30);		// Just to be safe...
-}
+    TRACE_BEGIN(Update);
+    PROFILE_BEGIN(PROBE_UPDATE);
 
-void Display::reset() {
+    // The controller sends whole bytes of the buffer, with its own addressing
+    bytes += Controller::template send<Link>(display_data, dirty_x0 / 8, dirty_y0, dirty_x1 / 8, dirty_y1);
+    updates++;
 
-    _reset();
+    // All sent
+    dirty_x0 = 0xFF;
+    dirty_x1 = 0;
 
-	// Configure display
-    _sendCommand(0b00110000);   // 8-bit mode.
-    _delay_us(100);
-    _sendCommand(0b00110000);	// 8-bit mode again.
-    _delay_us(110);
-    _sendCommand(0b00001100);   // Display on
-    _delay_us(100);
-    _sendCommand(0b00000001);   // Clears screen.
-    _delay_ms(2);
-    _sendCommand(0b00000110);   // Cursor moves right, no display shift.
-    _delay_us(80);
-    _sendCommand(0b00110100);   // Extended instruction set, 8bit
-    _delay_us(100);
-    _sendCommand(0b00110110);   // Repeat instruction with bit1 set
-    _delay_us(100);
+    PROFILE_END(PROBE_UPDATE);
+    TRACE_END(Update);
 }
 
-void Display::update() {
-    for(char y = 0; y < 64; y++) {
-        if(y < 32) {
-            _sendCommand(0x80 | y);
-            _sendCommand(0x80);
-        } else {
-            _sendCommand(0x80 | (y-32));
-            _sendCommand(0x88);
-        }
-        for(char x = 0; x < 16; x++) {
-            _sendData(display_data[x][y]);
-        }
-    }
+template<class Controller, class Link>
+uint16_t DisplayDriver<Controller, Link>::getUpdates() {
+    return updates;
 }
 
-void Display::clear() {
+template<class Controller, class Link>
+uint16_t DisplayDriver<Controller, Link>::getBytes() {
+    return bytes;
+}
+
+template<class Controller, class Link>
+void DisplayDriver<Controller, Link>::clear() {
     unsigned int x, y;
-    for(y=0; y<64; y++)
-        for(x=0; x<17; x++)
+    for(y=0; y<HEIGHT; y++)
+        for(x=0; x<WIDTH/8; x++)
             display_data[x][y]=0x00;
+
+    invalidate(0, 0, WIDTH, HEIGHT);
+}
+
+template<class Controller, class Link>
+void DisplayDriver<Controller, Link>::clear(int x, int y, int w, int h) {
+    for(int j=y; j<y+h; j++)
+        for(int i=x; i<x+w; i++)
+            setPixel(i, j, 0);
+
+    invalidate(x, y, w, h);
 }
 
-void Display::setPixel(int x, int y, int value) {
+template<class Controller, class Link>
+void DisplayDriver<Controller, Link>::invalidate(int x, int y, int w, int h) {
+    if(dirty_x0 > dirty_x1) {
+        // Nothing changed yet
+        dirty_x0 = x;
+        dirty_y0 = y;
+        dirty_x1 = x+w-1;
+        dirty_y1 = y+h-1;
+    } else {
+        // Bounding box of both areas
+        if(x < dirty_x0)		dirty_x0 = x;
+        if(y < dirty_y0)		dirty_y0 = y;
+        if(x+w-1 > dirty_x1)	dirty_x1 = x+w-1;
+        if(y+h-1 > dirty_y1)	dirty_y1 = y+h-1;
+    }
+}
+
+template<class Controller, class Link>
+void DisplayDriver<Controller, Link>::setPixel(int x, int y, int value) {
     int x_char = x/8;
-    int index = (7-x)%8;
+    int index = 7 - (x % 8);
     char buf = display_data[x_char][y];
 
     if(value==0) {
@@ -95,4 +123,17 @@ void Display::setPixel(int x, int y, int value) {
     }
 
     display_data[x_char][y]=buf;
-}
\ No newline at end of file
+}
+
+// The firmware only needs its controller; the host build has them all, to compare them (tools/display)
+#ifdef __AVR__
+template class DisplayDriver<Display::Controller_t, Display::Link_t>;
+#else
+template class DisplayDriver<ControllerSt7920>;
+template class DisplayDriver<ControllerSt7565>;
+template class DisplayDriver<ControllerSsd1306>;
+template class DisplayDriver<ControllerSt7565, DisplayUsart>;
+template class DisplayDriver<ControllerSsd1306, DisplayUsart>;
+template class DisplayDriver<ControllerSt7565, DisplayUsartPipeline>;
+template class DisplayDriver<ControllerSsd1306, DisplayUsartPipeline>;
+#endif
@@ -1,21 +1,91 @@
 #ifndef DISPLAY_H_
 #define DISPLAY_H_
 
+#include "../constants.h"
+
 #include <avr/io.h>
-#include <util/delay.h>
 
-#include "../constants.h"
+#include "../hal/Hal.h"
+
+#include "DisplayControllers.h"
+#include "DisplayUsart.h"
+#include "Pin.h"
+
+typedef PIN_T(PORT_DISPLAY_RESET, LINE_DISPLAY_RESET)	PinDisplayReset;
 
 /**
- *  Display control wrapper.
+ * Link to the display controller: hardware SPI and the A0 line. Each byte is sent before write()
+ * returns. DisplayUsart is the other link, with the same static methods.
  */
+struct DisplaySpi
+{
+	/** No bands: the bytes go one by one through write(). */
+	static const bool BANDS = false;
+	
+	/**
+	 * Configures SPI and the A0 line.
+	 * \return void
+	 */
+	static void init() {
+		hal_spi_init();
+		PinDisplayA0::output();
+	}
+	
+	/**
+	 * Sets the A0 line.
+	 * \param a0 level
+	 * \return void
+	 */
+	static void select(bool a0) {
+		if(a0)
+			PinDisplayA0::set();
+		else
+			PinDisplayA0::clear();
+	}
+	
+	/**
+	 * Sends a byte, waiting for the end of the transfer.
+	 * \param c byte
+	 * \return void
+	 */
+	static void write(uint8_t c) {
+		hal_spi_write(c);
+	}
+	
+	/**
+	 * Waits until everything written has been sent: nothing to wait for.
+	 * \return void
+	 */
+	static void flush() {
+	}
+};
 
-class Display
+/**
+ *  Display control wrapper, over a controller policy (see DisplayControllers.h) that gives the
+ *  geometry, the configuration and the way the buffer is sent. The policy is a template argument:
+ *  no virtual calls nor run time choice in update().
+ *  \tparam Controller controller policy
+ *  \tparam Link link to the controller
+ */
+template<class Controller, class Link = DisplaySpi>
+class DisplayDriver
 {
 	public:
+	/** Controller policy. */
+	typedef Controller Controller_t;
+	
+	/** Link to the controller. */
+	typedef Link Link_t;
+	
+	/** Width in pixels. */
+	static const uint8_t WIDTH = Controller::WIDTH;
+	
+	/** Height in pixels. */
+	static const uint8_t HEIGHT = Controller::HEIGHT;
+	
 	/**
 	 * \brief Initializes the display
-	 * by setting the I/O and configuring the ST7565 controller.
+	 * by setting the I/O and configuring the controller.
 	 * \return void
 	 */
 	void init();
@@ -34,56 +104,104 @@ class Display
 	
 	
 	/**
-	 * Updates display.
+	 * Updates display. Only the area changed since the last update is sent.
+	 * Over DisplayUsart it returns once the last bytes are queued, not sent.
 	 * \return void
 	 */
 	void update();
 	
 	
 	/**
-	 * Clears display buffer.
+	 * Clears display buffer. The whole display is sent at the next update.
 	 * \return void
 	 */
 	void clear();
 	
 	/**
-	 * \brief Resets the display.
-	 * It performs an hardware reset and reinitializes the ST7565 controller.
+	 * Clears an area of the display buffer and marks it as changed.
+	 * Pixels set with setPixel() inside the area are sent at the next update.
+	 * \param x horizontal position
+	 * \param y vertical position
+	 * \param w width
+	 * \param h height
 	 * \return void
 	 */
-	void reset();
-	
-	private:
-	
-	/** Display pixel buffer. */
-	char display_data[16][64]; 	// Don't judge me.
+	void clear(int, int, int, int);
 	
 	/**
-	 * Sends a single character trough the SPI interface.
-	 * \param c Character to be sent
+	 * Marks an area of the display buffer as changed, to be sent at the next update.
+	 * \param x horizontal position
+	 * \param y vertical position
+	 * \param w width
+	 * \param h height
 	 * \return void
 	 */
-	void _send(char);
+	void invalidate(int, int, int, int);
 	
 	/**
-	 * Sends a command to the ST7565 controller. DISPLAY_A0 is set to high.
-	 * \param c Command to be sent
+	 * \brief Resets the display.
+	 * It performs an hardware reset and reinitializes the controller.
 	 * \return void
 	 */
-	void _sendCommand(char c);
+	void reset();
 	
 	/**
-	 * Sends a byte of data to the ST7565 controller. DISPLAY_A0 is set to low.
-	 * \param c Data to be sent
-	 * \return void
+	 * Returns the number of updates that sent something, since init. Wraps around.
+	 * \return count
 	 */
-	void _sendData(char c);
+	uint16_t getUpdates();
 	
 	/**
-	 * Hard resets the ST7565 controller. DISPLAY_RESET set to high and then low.
+	 * Returns the number of data bytes sent to the controller, since init. Wraps around.
+	 * \return count
+	 */
+	uint16_t getBytes();
+	
+	private:
+	
+	/** Display pixel buffer, row oriented: 8 horizontal pixels per byte, most significant bit on the left. */
+	char display_data[WIDTH / 8][HEIGHT]; 	// Don't judge me.
+	
+	/** Changed area of the buffer in pixel, inclusive. Empty if dirty_x0 > dirty_x1. */
+	uint8_t dirty_x0, dirty_y0, dirty_x1, dirty_y1;
+	
+	/** Updates that sent something. */
+	uint16_t updates;
+	
+	/** Data bytes sent. */
+	uint16_t bytes;
+	
+	/**
+	 * Hard resets the controller. DISPLAY_RESET set to high and then low.
 	 * \return void
 	 */
 	void _reset();
 };
 
+#if DISPLAY_LINK == DISPLAY_LINK_SPI
+#if DISPLAY_PIPELINE
+#error "The band pipeline needs the interrupts of DISPLAY_LINK_USART"
+#endif
+typedef DisplaySpi		DisplayLink;
+#elif DISPLAY_LINK == DISPLAY_LINK_USART && DISPLAY_PIPELINE
+typedef DisplayUsartPipeline	DisplayLink;
+#elif DISPLAY_LINK == DISPLAY_LINK_USART
+typedef DisplayUsart	DisplayLink;
+#else
+#error "Unknown DISPLAY_LINK"
+#endif
+
+#if DISPLAY_CONTROLLER == DISPLAY_ST7920
+#if DISPLAY_LINK != DISPLAY_LINK_SPI
+#error "The ST7920 needs its busy waits between bytes: DISPLAY_LINK_SPI only"
+#endif
+typedef DisplayDriver<ControllerSt7920, DisplayLink>		Display;
+#elif DISPLAY_CONTROLLER == DISPLAY_ST7565
+typedef DisplayDriver<ControllerSt7565, DisplayLink>		Display;
+#elif DISPLAY_CONTROLLER == DISPLAY_SSD1306
+typedef DisplayDriver<ControllerSsd1306, DisplayLink>	Display;
+#else
+#error "Unknown DISPLAY_CONTROLLER"
+#endif
+
 #endif /* DISPLAY_H_ */
\ No newline at end of file
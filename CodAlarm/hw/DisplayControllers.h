@@ -0,0 +1,316 @@
+/*! \file */
+
+#ifndef DISPLAYCONTROLLERS_H_
+#define DISPLAYCONTROLLERS_H_
+
+#include "../constants.h"
+
+#include <avr/pgmspace.h>
+#include <stdint.h>
+
+#include "../hal/Hal.h"
+
+/*
+ * Display controller policies for DisplayDriver (see Display.h), chosen at compile time with
+ * DISPLAY_CONTROLLER. Everything is static and resolved at compile time, the byte loops included.
+ *
+ * A policy provides:
+ * - WIDTH, HEIGHT: geometry in pixels;
+ * - A0_COMMAND: level of the A0 (D/C) line for a command, the other level sends data;
+ * - configure<Link>(): commands after the hardware reset;
+ * - send<Link>(buffer, x0, y0, x1, y1): sends an area of the buffer with the addressing that suits
+ *   the controller, x0-x1 in bytes of the buffer and y0-y1 in rows, inclusive, and returns the
+ *   number of data bytes sent.
+ * The buffer is row oriented: buffer[x][y] holds 8 horizontal pixels, most significant bit on the
+ * left. Link (see DisplaySpi in Display.h) drives the A0 line and sends bytes, and may take the
+ * data in bands (Link::BANDS, see DisplayUsart.h).
+ */
+
+/** One row of display_transpose8(): its 8 pixels, left first, shifted into the 8 columns. */
+#define DISPLAY_TRANSPOSE_ROW(k) \
+    "ldd %[r], %a[in]+" #k "\n\t" \
+    "lsl %[r]\n\t"  "ror %[o0]\n\t" \
+    "lsl %[r]\n\t"  "ror %[o1]\n\t" \
+    "lsl %[r]\n\t"  "ror %[o2]\n\t" \
+    "lsl %[r]\n\t"  "ror %[o3]\n\t" \
+    "lsl %[r]\n\t"  "ror %[o4]\n\t" \
+    "lsl %[r]\n\t"  "ror %[o5]\n\t" \
+    "lsl %[r]\n\t"  "ror %[o6]\n\t" \
+    "lsl %[r]\n\t"  "ror %[o7]\n\t"
+
+/**
+ * Transposes a block of 8x8 pixels from the row oriented buffer to the layout of page oriented
+ * controllers: byte i of the result is column i of the block, left first, and its bit k is row k,
+ * top row in the least significant bit.
+ *
+ * Rows are taken top first; each one is shifted left through the carry, its leftmost pixel
+ * going into column 0, and rotated into the top of the columns, which move down a bit. After the
+ * 8 rows the first one is in bit 0. On AVR that is 8 loads and 64 lsl/ror pairs, 144 cycles, with
+ * the 8 columns in registers; the C version is the same algorithm.
+ * \param in 8 rows of the block, top first: consecutive in the buffer, which is column major
+ * \param out 8 column bytes
+ * \return void
+ */
+static inline void display_transpose8(const char* in, uint8_t* out) {
+#ifdef __AVR__
+    uint8_t r, o0, o1, o2, o3, o4, o5, o6, o7;
+
+    // The columns need no clearing: their first bits are rotated out
+    asm(
+        DISPLAY_TRANSPOSE_ROW(0)
+        DISPLAY_TRANSPOSE_ROW(1)
+        DISPLAY_TRANSPOSE_ROW(2)
+        DISPLAY_TRANSPOSE_ROW(3)
+        DISPLAY_TRANSPOSE_ROW(4)
+        DISPLAY_TRANSPOSE_ROW(5)
+        DISPLAY_TRANSPOSE_ROW(6)
+        DISPLAY_TRANSPOSE_ROW(7)
+        : [r] "=&r" (r),
+          [o0] "=&r" (o0), [o1] "=&r" (o1), [o2] "=&r" (o2), [o3] "=&r" (o3),
+          [o4] "=&r" (o4), [o5] "=&r" (o5), [o6] "=&r" (o6), [o7] "=&r" (o7)
+        : [in] "b" (in),
+          "m" (*(const char (*)[8]) in)
+    );
+
+    out[0] = o0;
+    out[1] = o1;
+    out[2] = o2;
+    out[3] = o3;
+    out[4] = o4;
+    out[5] = o5;
+    out[6] = o6;
+    out[7] = o7;
+#else
+    uint8_t column[8] = { 0 };
+
+    for(uint8_t k = 0; k < 8; k++) {
+        uint8_t row = in[k];
+        for(uint8_t i = 0; i < 8; i++) {
+            column[i] = (column[i] >> 1) | (row & 0x80);
+            row <<= 1;
+        }
+    }
+
+    for(uint8_t i = 0; i < 8; i++)
+        out[i] = column[i];
+#endif
+}
+
+/**
+ * Sends the data of a page oriented controller: columns of blocks x0 to x1 of a page, transposed
+ * (display_transpose8()), one byte at a time through Link::write(). A0 must be set for data.
+ * \tparam Link link to the controller
+ * \tparam BANDS whether the link takes bands: see the specialisation below
+ */
+template<class Link, bool BANDS = Link::BANDS>
+struct DisplayPageWriter {
+    template<uint8_t HEIGHT>
+    static void send(const char (*buffer)[HEIGHT], uint8_t x0, uint8_t x1, uint8_t page) {
+        uint8_t block[8];
+
+        for(uint8_t x = x0; x <= x1; x++) {
+            display_transpose8(&buffer[x][page * 8], block);
+            for(uint8_t i = 0; i < 8; i++)
+                Link::write(block[i]);
+        }
+    }
+};
+
+/**
+ * Same, in bands: the blocks are transposed straight into a band slot of the link, which sends
+ * it while the next one is filled.
+ */
+template<class Link>
+struct DisplayPageWriter<Link, true> {
+    template<uint8_t HEIGHT>
+    static void send(const char (*buffer)[HEIGHT], uint8_t x0, uint8_t x1, uint8_t page) {
+        uint8_t x = x0;
+
+        while(x <= x1) {
+            uint8_t* band = Link::band();
+            uint8_t length = 0;
+            do {
+                display_transpose8(&buffer[x][page * 8], band + length);
+                length += 8;
+                x++;
+            } while(x <= x1 && length < DISPLAY_BAND);
+            Link::queueBand(length);
+        }
+    }
+};
+
+/**
+ * Sitronix ST7920, 128x64, graphic mode of the extended instruction set. GDRAM is addressed by row
+ * and 16-bit word, the bottom half of the panel following the top half in each row: an area is
+ * sent row by row, whole words, with two address commands per row.
+ */
+struct ControllerSt7920 {
+    static const uint8_t WIDTH = 128;
+    static const uint8_t HEIGHT = 64;
+    static const bool A0_COMMAND = true;
+
+    template<class Link>
+    static void configure() {
+        _command<Link>(0b00110000);   // 8-bit mode.
+        hal_delay_us(100);
+        _command<Link>(0b00110000);   // 8-bit mode again.
+        hal_delay_us(110);
+        _command<Link>(0b00001100);   // Display on
+        hal_delay_us(100);
+        _command<Link>(0b00000001);   // Clears screen.
+        hal_delay_ms(2);
+        _command<Link>(0b00000110);   // Cursor moves right, no display shift.
+        hal_delay_us(80);
+        _command<Link>(0b00110100);   // Extended instruction set, 8bit
+        hal_delay_us(100);
+        _command<Link>(0b00110110);   // Repeat instruction with bit1 set
+        hal_delay_us(100);
+    }
+
+    template<class Link>
+    static uint16_t send(const char (*buffer)[HEIGHT], uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1) {
+        // Horizontal addressing is in 16-bit words
+        x0 &= ~1;
+        x1 |= 1;
+
+        for(uint8_t y = y0; y <= y1; y++) {
+            if(y < 32) {
+                _command<Link>(0x80 | y);
+                _command<Link>(0x80 | (x0 / 2));
+            } else {
+                _command<Link>(0x80 | (y-32));
+                _command<Link>(0x88 | (x0 / 2));
+            }
+            for(uint8_t x = x0; x <= x1; x++)
+                _data<Link>(buffer[x][y]);
+        }
+
+        return (uint16_t) (y1 - y0 + 1) * (x1 - x0 + 1);
+    }
+
+private:
+    template<class Link>
+    static void _command(uint8_t c) {
+        Link::select(A0_COMMAND);
+        hal_delay_us(15);
+        Link::write(c);
+    }
+
+    template<class Link>
+    static void _data(uint8_t c) {
+        Link::select(!A0_COMMAND);
+        hal_delay_us(15);
+        Link::write(c);
+    }
+};
+
+/**
+ * Sitronix ST7565, 128x64 of its 132x65 RAM. Page addressing: 8 pages of 8 rows, a byte is a column
+ * of 8 pixels. An area is sent page by page, with three address commands per page.
+ */
+struct ControllerSt7565 {
+    static const uint8_t WIDTH = 128;
+    static const uint8_t HEIGHT = 64;
+    static const bool A0_COMMAND = false;
+
+    template<class Link>
+    static void configure() {
+        static const uint8_t sequence[] PROGMEM = {
+            0xA2,           // LCD bias 1/9
+            0xA0,           // Columns left to right
+            0xC8,           // Rows top to bottom
+            0x40,           // Display start line 0
+            0x2F,           // Booster, regulator and follower on
+            0x26,           // Regulator resistor ratio
+            0x81, 0x18,     // Contrast
+            0xAF,           // Display on
+        };
+
+        for(uint8_t i = 0; i < sizeof(sequence); i++)
+            _command<Link>(pgm_read_byte(&sequence[i]));
+    }
+
+    template<class Link>
+    static uint16_t send(const char (*buffer)[HEIGHT], uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1) {
+        for(uint8_t page = y0 / 8; page <= y1 / 8; page++) {
+            _command<Link>(0xB0 | page);
+            _command<Link>(0x10 | (x0 >> 1));       // Column x0 * 8, high nibble
+            _command<Link>(0x00 | ((x0 & 1) << 3)); // Low nibble
+
+            Link::select(!A0_COMMAND);
+            DisplayPageWriter<Link>::send(buffer, x0, x1, page);
+        }
+
+        return (uint16_t) (y1 / 8 - y0 / 8 + 1) * (x1 - x0 + 1) * 8;
+    }
+
+private:
+    template<class Link>
+    static void _command(uint8_t c) {
+        Link::select(A0_COMMAND);
+        Link::write(c);
+    }
+
+};
+
+/**
+ * Solomon SSD1306, 128x64, 4-wire SPI. Same page layout as the ST7565, but in horizontal
+ * addressing mode: an area is a window set once with six command bytes, then its data is sent in
+ * a single stream, the controller moving to the next page at the right edge of the window.
+ */
+struct ControllerSsd1306 {
+    static const uint8_t WIDTH = 128;
+    static const uint8_t HEIGHT = 64;
+    static const bool A0_COMMAND = false;
+
+    template<class Link>
+    static void configure() {
+        static const uint8_t sequence[] PROGMEM = {
+            0xAE,           // Display off
+            0xD5, 0x80,     // Clock divide and oscillator frequency
+            0xA8, 0x3F,     // Multiplex ratio: 64 rows
+            0xD3, 0x00,     // Display offset
+            0x40,           // Display start line 0
+            0x8D, 0x14,     // Charge pump on
+            0x20, 0x00,     // Horizontal addressing mode
+            0xA1,           // Columns left to right
+            0xC8,           // Rows top to bottom
+            0xDA, 0x12,     // COM pins configuration
+            0x81, 0xCF,     // Contrast
+            0xD9, 0xF1,     // Precharge period
+            0xDB, 0x40,     // VCOMH level
+            0xA4,           // Display from RAM
+            0xA6,           // Not inverted
+            0xAF,           // Display on
+        };
+
+        for(uint8_t i = 0; i < sizeof(sequence); i++)
+            _command<Link>(pgm_read_byte(&sequence[i]));
+    }
+
+    template<class Link>
+    static uint16_t send(const char (*buffer)[HEIGHT], uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1) {
+        // Window: columns, then pages
+        _command<Link>(0x21);
+        _command<Link>(x0 * 8);
+        _command<Link>(x1 * 8 + 7);
+        _command<Link>(0x22);
+        _command<Link>(y0 / 8);
+        _command<Link>(y1 / 8);
+
+        Link::select(!A0_COMMAND);
+        for(uint8_t page = y0 / 8; page <= y1 / 8; page++)
+            DisplayPageWriter<Link>::send(buffer, x0, x1, page);
+
+        return (uint16_t) (y1 / 8 - y0 / 8 + 1) * (x1 - x0 + 1) * 8;
+    }
+
+private:
+    template<class Link>
+    static void _command(uint8_t c) {
+        Link::select(A0_COMMAND);
+        Link::write(c);
+    }
+};
+
+#endif /* DISPLAYCONTROLLERS_H_ */
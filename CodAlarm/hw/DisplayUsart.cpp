@@ -0,0 +1,71 @@
+#include "DisplayUsart.h"
+
+#include <util/atomic.h>
+
+uint8_t DisplayUsart::data[DISPLAY_USART_BUFFER];
+uint8_t DisplayUsart::flags[DISPLAY_USART_BUFFER];
+volatile uint8_t DisplayUsart::head = 0;
+volatile uint8_t DisplayUsart::tail = 0;
+bool DisplayUsart::level = false;
+volatile bool DisplayUsart::loaded = false;
+bool DisplayUsart::line = false;
+uint8_t DisplayUsart::bands[2][DISPLAY_BAND];
+uint8_t DisplayUsart::band_length[2];
+volatile bool DisplayUsart::band_busy[2] = { false, false };
+uint8_t DisplayUsart::band_next = 0;
+uint8_t DisplayUsart::band_position = 0;
+
+void DisplayUsart::init() {
+    hal_usart_spi_init(DISPLAY_USART_UBRR);
+    PinDisplayA0::output();
+    PinDisplayA0::clear();
+    line = false;
+}
+
+void DisplayUsart::write(uint8_t c) {
+    _queue(c, level ? QUEUED_A0 : 0);
+}
+
+uint8_t* DisplayUsart::band() {
+    // Both slots queued: wait for the older one to be sent
+    while(band_busy[band_next])
+        hal_idle();
+
+    return bands[band_next];
+}
+
+void DisplayUsart::queueBand(uint8_t length) {
+    band_length[band_next] = length;
+    band_busy[band_next] = true;
+    _queue(band_next, QUEUED_BAND | (level ? QUEUED_A0 : 0));
+    band_next ^= 1;
+}
+
+void DisplayUsart::_queue(uint8_t c, uint8_t f) {
+    uint8_t next = (head + 1) & (DISPLAY_USART_BUFFER - 1);
+
+    // Full: wait for the interrupt to make room
+    while(next == tail)
+        hal_idle();
+
+    data[head] = c;
+    flags[head] = f;
+    head = next;
+
+    // Start sending, unless waiting for sent() to change A0
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        if(!(UCSR0B & (1 << TXCIE0)))
+            UCSR0B |= (1 << UDRIE0);
+    }
+}
+
+void DisplayUsart::flush() {
+    while(head != tail)
+        hal_idle();
+
+    // The last byte loaded is still shifting out
+    if(loaded)
+        while(!hal_usart_spi_sent())
+            hal_idle();
+    loaded = false;
+}
@@ -0,0 +1,201 @@
+#ifndef DISPLAYUSART_H_
+#define DISPLAYUSART_H_
+
+#include "../constants.h"
+
+#include <avr/io.h>
+#include <stdint.h>
+
+#include "../hal/Hal.h"
+
+#include "Pin.h"
+
+typedef PIN_T(PORT_DISPLAY_A0, LINE_DISPLAY_A0)			PinDisplayA0;
+
+static_assert(DISPLAY_USART_BUFFER <= 256 && (DISPLAY_USART_BUFFER & (DISPLAY_USART_BUFFER - 1)) == 0, "DisplayUsart: DISPLAY_USART_BUFFER must be a power of 2");
+static_assert(DISPLAY_BAND >= 8 && DISPLAY_BAND <= 128 && DISPLAY_BAND % 8 == 0, "DisplayUsart: DISPLAY_BAND must be 8 to 128 bytes, whole 8x8 blocks");
+
+/**
+ * \brief Link to the display controller over USART0 in master SPI mode (see DisplaySpi in Display.h).
+ * TXD is the data and XCK the clock. The transmit buffer of the USART is double buffered: bytes
+ * are queued with their A0 level by write(), and sent back to back by transmit() (USART_UDRE
+ * interrupt); write() only waits when the queue is full.
+ * The controller samples A0 with the last bit of a byte, so A0 only changes once the bytes before
+ * have left: transmit() then waits for the USART_TX interrupt, sent().
+ * Bands are the other way to send data: two slots of DISPLAY_BAND bytes, filled in place with
+ * band() and queued whole with queueBand(), so that the next band is filled while one is sent.
+ * A queued band takes a single place in the queue, keeping the order with the bytes written.
+ * Everything is static, as the link is a template argument of DisplayDriver.
+ */
+class DisplayUsart {
+
+public:
+    /** Whether the page controllers send their data in bands: see DisplayUsartPipeline. */
+    static const bool BANDS = false;
+
+    /**
+     * Configures the USART at DISPLAY_USART_UBRR and the A0 line.
+     * \return void
+     */
+    static void init();
+
+    /**
+     * Sets the A0 level of the next bytes written.
+     * \param a0 level
+     * \return void
+     */
+    static void select(bool a0) {
+        level = a0;
+    }
+
+    /**
+     * Queues a byte, waiting for room if the queue is full.
+     * \param c byte
+     * \return void
+     */
+    static void write(uint8_t);
+
+    /**
+     * Returns the band slot to fill next, waiting until the feeder has sent what it held: at most
+     * two bands are queued, sent or being filled.
+     * \return DISPLAY_BAND bytes to fill
+     */
+    static uint8_t* band();
+
+    /**
+     * Queues the band slot returned by band(), to be sent with the current A0 level.
+     * \param length bytes filled, 1 to DISPLAY_BAND
+     * \return void
+     */
+    static void queueBand(uint8_t);
+
+    /**
+     * Waits until everything queued has left the USART.
+     * \return void
+     */
+    static void flush();
+
+    /**
+     * Sends the next queued byte, or waits for sent() if A0 must change, or disables the
+     * interrupt once the queue is empty. Must be called by the USART_UDRE interrupt.
+     * Inline, as sent(): called once per byte, the interrupt then only saves the registers it uses.
+     * \return void
+     */
+    static void transmit() {
+        // Nothing loaded since the last flush: the flag may not be set yet
+        _feed(!loaded || hal_usart_spi_sent());
+    }
+
+    /**
+     * Disables the USART_TX interrupt and sends the next byte. Must be called by the USART_TX interrupt.
+     * \return void
+     */
+    static void sent() {
+        UCSR0B &= ~(1 << TXCIE0);
+        _feed(true);
+    }
+
+private:
+    /** Flags of a queued byte: its A0 level, and whether it is the slot of a band. */
+    static const uint8_t QUEUED_A0 = 1;
+    static const uint8_t QUEUED_BAND = 2;
+
+    /** Queued bytes, or band slots, and their flags. */
+    static uint8_t data[DISPLAY_USART_BUFFER];
+    static uint8_t flags[DISPLAY_USART_BUFFER];
+
+    /** Next free position, written by write(). */
+    static volatile uint8_t head;
+
+    /** Next byte to send, written by transmit(). */
+    static volatile uint8_t tail;
+
+    /** A0 level of the next bytes written. */
+    static bool level;
+
+    /** Whether bytes were loaded since the last flush(). */
+    static volatile bool loaded;
+
+    /** A0 level of the bytes loaded, changed by _feed() only. */
+    static bool line;
+
+    /** Band slots and their length. */
+    static uint8_t bands[2][DISPLAY_BAND];
+    static uint8_t band_length[2];
+
+    /** Slots queued and not yet sent, cleared by _feed(): one byte each, never read-modify-written. */
+    static volatile bool band_busy[2];
+
+    /** Slot band() returns next. */
+    static uint8_t band_next;
+
+    /** Position in the band being sent. */
+    static uint8_t band_position;
+
+    /**
+     * Queues an entry, waiting for room if the queue is full.
+     * \param c byte, or band slot
+     * \param f flags
+     * \return void
+     */
+    static void _queue(uint8_t, uint8_t);
+
+    /**
+     * Sends the next queued byte.
+     * \param idle true if everything loaded has left: A0 can change
+     * \return void
+     */
+    static void _feed(bool idle) {
+        if(tail == head) {
+            // Nothing left to send
+            UCSR0B &= ~(1 << UDRIE0);
+            return;
+        }
+
+        uint8_t t = tail;
+        uint8_t f = flags[t];
+        if((bool) (f & QUEUED_A0) != line) {
+            if(!idle) {
+                // A0 changes after the bytes loaded: wait for them to leave
+                UCSR0B = (UCSR0B & ~(1 << UDRIE0)) | (1 << TXCIE0);
+                return;
+            }
+            line = f & QUEUED_A0;
+            PinDisplayA0::write(line);
+        }
+
+        loaded = true;
+        if(f & QUEUED_BAND) {
+            // The band stays at the head of the queue until its last byte
+            uint8_t slot = data[t];
+            hal_usart_spi_load(bands[slot][band_position++]);
+            if(band_position < band_length[slot]) {
+                UCSR0B |= (1 << UDRIE0);
+                return;
+            }
+            band_position = 0;
+            band_busy[slot] = false;
+        } else {
+            hal_usart_spi_load(data[t]);
+        }
+        t = (t + 1) & (DISPLAY_USART_BUFFER - 1);
+        tail = t;
+
+        // Next bytes on USART_UDRE, back from sent() too. Once the queue is empty write()
+        // enables it again: no interrupt just to find the queue empty
+        if(t == head)
+            UCSR0B &= ~(1 << UDRIE0);
+        else
+            UCSR0B |= (1 << UDRIE0);
+    }
+};
+
+/**
+ * DisplayUsart with the band pipeline (DISPLAY_PIPELINE): the page controllers transpose their
+ * data into a band while the feeder sends the previous one.
+ */
+struct DisplayUsartPipeline : DisplayUsart {
+    static const bool BANDS = true;
+};
+
+#endif /* DISPLAYUSART_H_ */
@@ -0,0 +1,55 @@
+#include "Eeprom.h"
+
+#include <avr/eeprom.h>
+#include <util/atomic.h>
+
+void Eeprom::read(void* dst, uint16_t addr, uint8_t n) {
+    // Wait for the background write, it uses the address register
+    while(busy());
+
+    eeprom_read_block(dst, (const void*) (uintptr_t) addr, n);
+}
+
+bool Eeprom::write(uint16_t addr, const void* src, uint8_t n) {
+    if(busy() || n > EEPROM_BUFFER)
+        return false;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        // The interrupt of the previous write may still be enabled
+        for(uint8_t i=0; i<n; i++)
+            buffer[i] = ((const uint8_t*) src)[i];
+
+        address = addr;
+        index = 0;
+        length = n;
+
+        // Interrupt fires as soon as the EEPROM is ready
+        EECR |= (1 << EERIE);
+    }
+    return true;
+}
+
+bool Eeprom::busy() {
+    return index < length;
+}
+
+void Eeprom::ready() {
+    // Skip bytes that don't change
+    while(index < length) {
+        EEAR = address + index;
+        EECR |= (1 << EERE);
+        if(EEDR != buffer[index])
+            break;
+        index++;
+    }
+
+    if(index >= length) {
+        // Done
+        EECR &= ~(1 << EERIE);
+        return;
+    }
+
+    EEDR = buffer[index++];
+    EECR |= (1 << EEMPE);	// Master write enable...
+    EECR |= (1 << EEPE);	// ... write within 4 cycles
+}
@@ -0,0 +1,65 @@
+#ifndef EEPROM_H_
+#define EEPROM_H_
+
+#include "../constants.h"
+
+#include <avr/io.h>
+#include <stdint.h>
+
+/** Largest block that can be written at once, in bytes. */
+#define EEPROM_BUFFER		8
+
+/**
+ * \brief Non-blocking EEPROM wrapper.
+ * Writes are copied to a buffer and performed one byte at a time from the EE_READY interrupt, so
+ * the 3.3 ms programming time of each byte never stalls the main loop. Bytes that already hold
+ * the value to be written are skipped to save wear.
+ */
+class Eeprom {
+
+public:
+    /**
+     * Reads a block. Waits for a pending write to complete.
+     * \param dst destination buffer
+     * \param addr EEPROM address
+     * \param n number of bytes
+     * \return void
+     */
+    void read(void*, uint16_t, uint8_t);
+
+    /**
+     * Starts writing a block in background.
+     * \param addr EEPROM address
+     * \param src data, copied before returning
+     * \param n number of bytes, at most EEPROM_BUFFER
+     * \return bool false if a write is still in progress: nothing is written
+     */
+    bool write(uint16_t, const void*, uint8_t);
+
+    /**
+     * Returns if a write is in progress.
+     * \return bool true if busy
+     */
+    bool busy();
+
+    /**
+     * Writes the next byte of the block. Must be called from the EE_READY interrupt.
+     * \return void
+     */
+    void ready();
+
+private:
+    /** Data being written. */
+    uint8_t buffer[EEPROM_BUFFER];
+
+    /** EEPROM address of the first byte of the buffer. */
+    uint16_t address;
+
+    /** Number of bytes in the buffer. */
+    volatile uint8_t length;
+
+    /** Index of the next byte to be written. */
+    volatile uint8_t index;
+};
+
+#endif /* EEPROM_H_ */
@@ -1,10 +1,13 @@
 #ifndef IO_H_
 #define IO_H_
 
+#include "../constants.h"
+
 #include <avr/io.h>
-#include <util/delay.h>
 
-#include "../constants.h"
+#include "../hal/Hal.h"
+
+#include "Pin.h"
 
 /** Number of possible short press events/handlers. */
 #define N_PRESSEVENTS_SHORT	7
@@ -23,7 +26,16 @@ enum t_button {
     SNOOZE,
 };
 
-typedef void (*Handler) (void);
+typedef PIN_T(PORT_BACKLIGHT, LINE_BACKLIGHT)			PinBacklight;
+typedef PIN_T(PORT_BUZZER, LINE_BUZZER)					PinBuzzer;
+typedef PIN_T(PORT_SWITCH, LINE_SWITCH)					PinSwitch;
+typedef PIN_T(PORT_BTN_SET_ALARM, LINE_BTN_SET_ALARM)	PinBtnSetAlarm;
+typedef PIN_T(PORT_BTN_SET_CLOCK, LINE_BTN_SET_CLOCK)	PinBtnSetClock;
+typedef PIN_T(PORT_BTN_STOP_ALARM, LINE_BTN_STOP_ALARM)	PinBtnStopAlarm;
+typedef PIN_T(PORT_BTN_UP, LINE_BTN_UP)					PinBtnUp;
+typedef PIN_T(PORT_BTN_DOWN, LINE_BTN_DOWN)				PinBtnDown;
+typedef PIN_T(PORT_BTN_MODE, LINE_BTN_MODE)				PinBtnMode;
+typedef PIN_T(PORT_BTN_SNOOZE, LINE_BTN_SNOOZE)			PinBtnSnooze;
 
 /**
  * I/O wrapper. Controls all peripherals except the display, that is managed by the Display class.
@@ -58,42 +70,23 @@ public:
      */
     void buzz();
 
-    /**
-     * Sets an handler function for a given button short press event.
-     * \param button button
-     * \param handler handler function
-     * \return void
-     */
-    void setPressHandler(t_button, Handler);
-
-    /**
-     * Sets an handler function for any button short press event. Used for events shared by all buttons.
-     * \param handler handler function
-     * \return void
-     */
-    void setPressHandler(Handler);
-
-    /**
-     * Sets an handler function for a given button long press event.
-     * \param button Button
-     * \param handler handler function
-     * \return void
-     */
-    void setLongHandler(t_button, Handler);
-
     /**
     * When called, it compares the button state with the one from a previous call to detect a button press-down event. If no
     * previous record is available, all buttons are assumed as not pressed. If a press-down is detected the short press event
-    * handler for that button is called as well as the generic one. Debounce is synchronous and has a delay of
+    * handler for that button is called as well as the generic one. Debounce is synchronous and has a delay of DELAY_DEBOUNCE ms.
+    * \tparam Handlers class providing the static handlers pressAny() and press(t_button), bound at compile time
     * \return void
     */
+    template<class Handlers>
     void checkPress();
 
     /**
     * When called, if a button is pressed, a counter is incremented for that button, or reset otherwise. If a button remains pressed
-    * for LONG_PRESS_N separate calls, the long press event handler is generated for that button and counting is suspended.
+    * for N_LONG_PRESS separate calls, the long press event handler is generated for that button and counting is suspended.
+    * \tparam Handlers class providing the static handler longPress(t_button), bound at compile time
     * \return void
     */
+    template<class Handlers>
     void countCheckLong();
 
 private:
@@ -103,15 +96,6 @@ private:
     /** Stores how many consecutive countCheckLong calls have detected a button pressed. */
     int  pressed_cnt[N_PRESSEVENTS_LONG];
 
-    /** Short press handler array for each button. */
-    Handler press_handler_array[N_PRESSEVENTS_SHORT];
-
-    /** Short press handler array for a generic button. */
-    Handler press_handler_generic;
-
-    /** Long press handler array for each button. */
-    Handler long_handler_array[N_PRESSEVENTS_SHORT];
-
     /**
      * Resets internal variables (pressed and pressed_cnt).
      * \return void
@@ -127,4 +111,70 @@ private:
 
 };
 
+// Handlers are static members of a class given as template parameter: they are called directly
+// (or inlined), without function pointers in SRAM.
+
+template<class Handlers>
+void IO::checkPress() {
+    for(int i=0; i<N_PRESSEVENTS_SHORT; i++) {
+        bool value = _getBtnValue((t_button) i);
+
+        // Released -> Pressed
+        if(value && !pressed[i]) {
+            // Button appears to be pressed... debounce!
+            hal_delay_ms(DELAY_DEBOUNCE);	// Software debounce
+            if(_getBtnValue((t_button) i)) {
+                pressed[i] = true;		// Change state for button
+                Handlers::pressAny();
+                Handlers::press((t_button) i);	// Call the button handler
+            }
+        }
+
+        // Pressed -> Released
+        if(!value && pressed[i]) {
+            // Button appears to be released... debounce!
+            hal_delay_ms(DELAY_DEBOUNCE);	// Software debounce
+            if(!_getBtnValue((t_button) i)) {
+                pressed[i] = false;		// Change state for button
+            }
+        }
+    }
+}
+
+template<class Handlers>
+void IO::countCheckLong() {
+    for(int i=0; i<N_PRESSEVENTS_LONG; i++) {
+        if(pressed[i]) {
+            // If button is pressed
+            if(pressed_cnt[i] < N_LONG_PRESS) {
+                // Time not elapsed
+                pressed_cnt[i]++;
+
+                if(pressed_cnt[i] == N_LONG_PRESS) {
+                    // Time just elapsed
+                    Handlers::longPress((t_button) i);
+                }
+            }
+        } else {
+            // If not pressed, keep count to 0!
+            pressed_cnt[i] = 0;
+        }
+    }
+}
+
+// Called from ISRs: defined inline so they compile to a single instruction, without a call.
+
+inline bool IO::getSwitch() {
+    // TODO: Check if high/low
+    return PinSwitch::read();
+}
+
+inline void IO::setLight(bool state) {
+    PinBacklight::write(state);
+}
+
+inline void IO::buzz() {
+    PinBuzzer::toggle();
+}
+
 #endif /* IO_H_ */
\ No newline at end of file
@@ -0,0 +1,111 @@
+/*! \file */
+
+#ifndef PIN_H_
+#define PIN_H_
+
+#include "../constants.h"
+
+#include <avr/io.h>
+#include <stdint.h>
+
+/**
+ * Declares a port type returning its PINx, DDRx and PORTx registers. The registers are
+ * compile time constants, so the accesses made by Pin are resolved to fixed I/O addresses.
+ */
+#define DECLARE_PORT(x)													\
+	struct CONCAT(Port,x) {												\
+		static volatile uint8_t& pin()	{ return PIN(x); }				\
+		static volatile uint8_t& ddr()	{ return DDR(x); }				\
+		static volatile uint8_t& port()	{ return PORT(x); }				\
+	};
+
+DECLARE_PORT(B)
+DECLARE_PORT(C)
+DECLARE_PORT(D)
+
+/** Pin type from a port letter and a line, as defined in the pinout of constants.h. */
+#define PIN_T(port, line)	Pin<CONCAT(Port,port), line>
+
+/**
+ * \brief Zero-cost digital pin.
+ * Every method is a single bit operation on a register in the low I/O space, which avr-gcc
+ * compiles to a single sbi, cbi, sbis or sbic instruction (with optimization enabled, as in both
+ * project configurations). Single bit instructions don't read-modify-write the whole register,
+ * so pins of the same port can be changed from ISRs and main code without disabling interrupts.
+ * \tparam Port port type declared with DECLARE_PORT
+ * \tparam Bit line number, 0 to 7
+ */
+template<class Port, uint8_t Bit>
+class Pin {
+
+	static_assert(Bit < 8, "Pin: line must be between 0 and 7");
+
+public:
+
+	/** Bit mask of the line. */
+	static const uint8_t mask = 1 << Bit;
+
+	/**
+	 * Configures the pin as output.
+	 * \return void
+	 */
+	static inline void output() {
+		Port::ddr() |= mask;
+	}
+
+	/**
+	 * Configures the pin as input.
+	 * \return void
+	 */
+	static inline void input() {
+		Port::ddr() &= (uint8_t) ~mask;
+	}
+
+	/**
+	 * Sets the output high, or enables the pull-up resistor of an input.
+	 * \return void
+	 */
+	static inline void set() {
+		Port::port() |= mask;
+	}
+
+	/**
+	 * Sets the output low, or disables the pull-up resistor of an input.
+	 * \return void
+	 */
+	static inline void clear() {
+		Port::port() &= (uint8_t) ~mask;
+	}
+
+	/**
+	 * Sets the output to a value.
+	 * \param value true for high
+	 * \return void
+	 */
+	static inline void write(bool value) {
+		if(value) {
+			set();
+		} else {
+			clear();
+		}
+	}
+
+	/**
+	 * Toggles the output. Writing a one to PINx toggles PORTx on the ATmega328P; sbi
+	 * only writes the selected bit, so the other lines are not affected.
+	 * \return void
+	 */
+	static inline void toggle() {
+		Port::pin() |= mask;
+	}
+
+	/**
+	 * Reads the pin value.
+	 * \return bool true if high
+	 */
+	static inline bool read() {
+		return Port::pin() & mask;
+	}
+};
+
+#endif /* PIN_H_ */
@@ -0,0 +1,38 @@
+#include "Profile.h"
+
+#if PROFILE
+
+#include <avr/pgmspace.h>
+
+volatile uint8_t profile_overflows = 0;
+
+t_probe_stats profile_table[N_PROBES] = {
+	{ 0, 0xFFFF, 0, 0 }, { 0, 0xFFFF, 0, 0 }, { 0, 0xFFFF, 0, 0 }, { 0, 0xFFFF, 0, 0 }
+};
+
+uint16_t profile_latency[N_LATENCIES][N_LATENCY_BUCKETS] = {};
+
+/** Probe names, in the order of t_probe. */
+static const char PROBE_NAMES[N_PROBES][7] PROGMEM = {
+	"t0", "t1", "draw", "update"
+};
+
+void profile_read(t_probe probe, t_probe_stats* stats) {
+	// Interrupt probes change while being read
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		*stats = profile_table[probe];
+	}
+}
+
+void profile_read_latency(t_probe probe, uint16_t* counts) {
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		for(uint8_t i = 0; i < N_LATENCY_BUCKETS; i++)
+			counts[i] = profile_latency[probe][i];
+	}
+}
+
+const char* profile_name(t_probe probe) {
+	return PROBE_NAMES[probe];
+}
+
+#endif
@@ -0,0 +1,191 @@
+/*! \file */
+
+#ifndef PROFILE_H_
+#define PROFILE_H_
+
+#include "../constants.h"
+#include "../timers.h"
+
+#include <avr/io.h>
+#include <stdint.h>
+#include <util/atomic.h>
+
+/*
+ * Profiler of interrupts and drawing, built in with PROFILE set to 1 (see constants.h).
+ *
+ * A probe is a section of code between PROFILE_BEGIN() and PROFILE_END(), in the same block. Its
+ * durations are kept in a table, in profiler ticks: Timer0 counts, TIMER0_CFG.div CPU cycles each,
+ * extended to 16 bits by counting Timer0 overflows. Interrupt probes start after the interrupt
+ * prologue; main loop probes also count the interrupts that ran in between.
+ *
+ * The latency of the timer interrupts is the timer count read first thing in the interrupt, the
+ * time since the overflow or compare match, prologue included. It is kept in a histogram of
+ * N_LATENCY_BUCKETS buckets per interrupt: bucket 0 counts 0 ticks, bucket b counts 2^(b-1) to
+ * 2^b - 1 ticks, the last bucket everything above. Ticks are those of the interrupt's timer, see
+ * profile_latency_cycles().
+ *
+ * A stamp takes about 12 cycles and recording about 40 more. With PROFILE set to 0 the macros
+ * expand to nothing.
+ */
+
+/** Sections measured. */
+enum t_probe {
+	/** TIMER0_OVF interrupt. */
+	PROBE_TIMER0,
+	/** TIMER1_COMPA interrupt. */
+	PROBE_TIMER1,
+	/** GUI::draw(), display update included. */
+	PROBE_DRAW,
+	/** Display::update(), when something is sent. */
+	PROBE_UPDATE
+};
+
+/** Number of probes in t_probe. */
+#define N_PROBES	4
+
+/** Durations of a probe, profiler ticks. */
+struct t_probe_stats {
+	/** Number of runs, stops at 0xFFFF. */
+	uint16_t count;
+	/** Shortest and longest run. */
+	uint16_t min;
+	uint16_t max;
+	/** Sum of the runs counted, for the mean. */
+	uint32_t sum;
+};
+
+/** Number of interrupts with a latency histogram: the first probes, PROBE_TIMER0 and PROBE_TIMER1. */
+#define N_LATENCIES			2
+
+/** Buckets of a latency histogram. */
+#define N_LATENCY_BUCKETS	8
+
+static_assert(PROBE_TIMER0 < N_LATENCIES && PROBE_TIMER1 < N_LATENCIES, "Profile: timer probes must come first, they index the latencies");
+
+#if PROFILE
+
+/** Timer0 overflows, high byte of the profiler timestamp. */
+extern volatile uint8_t profile_overflows;
+
+/** Durations, indexed by t_probe. */
+extern t_probe_stats profile_table[N_PROBES];
+
+/** Latency histograms, indexed by t_probe. Counts stop at 0xFFFF. */
+extern uint16_t profile_latency[N_LATENCIES][N_LATENCY_BUCKETS];
+
+/**
+ * Reads the profiler timestamp.
+ * \return Timer0 overflows and count
+ */
+static inline uint16_t profile_now() {
+	uint8_t high, low;
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		high = profile_overflows;
+		low = TCNT0;
+
+		// Overflow not counted yet: the Timer0 interrupt is pending
+		if((TIFR0 & (1 << TOV0)) && low < 128)
+			high++;
+	}
+
+	return ((uint16_t) high << 8) | low;
+}
+
+/**
+ * Adds a run to the table. Each probe is recorded from a single context, interrupt or main loop.
+ * \param probe probe
+ * \param ticks duration
+ * \return void
+ */
+static inline void profile_record(t_probe probe, uint16_t ticks) {
+	t_probe_stats* stats = &profile_table[probe];
+
+	if(ticks < stats->min)
+		stats->min = ticks;
+	if(ticks > stats->max)
+		stats->max = ticks;
+
+	if(stats->count != 0xFFFF) {
+		stats->count++;
+		stats->sum += ticks;
+	}
+}
+
+/**
+ * Adds a latency to the histogram of a timer interrupt. Must be called by that interrupt.
+ * \param probe PROBE_TIMER0 or PROBE_TIMER1
+ * \param ticks timer count
+ * \return void
+ */
+static inline void profile_latency_record(t_probe probe, uint16_t ticks) {
+	uint8_t bucket = 0;
+
+	// Bucket of the highest bit set
+	while(ticks && bucket < N_LATENCY_BUCKETS - 1) {
+		ticks >>= 1;
+		bucket++;
+	}
+
+	uint16_t* count = &profile_latency[probe][bucket];
+	if(*count != 0xFFFF)
+		(*count)++;
+}
+
+/**
+ * Returns the CPU cycles per tick of a latency histogram.
+ * \param probe PROBE_TIMER0 or PROBE_TIMER1
+ * \return cycles
+ */
+static inline uint16_t profile_latency_cycles(t_probe probe) {
+	return probe == PROBE_TIMER0 ? TIMER0_CFG.div : TIMER1_CFG.div;
+}
+
+/**
+ * Reads the latency histogram of a timer interrupt, atomically.
+ * \param probe PROBE_TIMER0 or PROBE_TIMER1
+ * \param counts destination, N_LATENCY_BUCKETS counts
+ * \return void
+ */
+void profile_read_latency(t_probe, uint16_t*);
+
+/**
+ * Reads the durations of a probe, atomically.
+ * \param probe probe
+ * \param stats destination
+ * \return void
+ */
+void profile_read(t_probe, t_probe_stats*);
+
+/**
+ * Returns the name of a probe.
+ * \param probe probe
+ * \return name, in flash
+ */
+const char* profile_name(t_probe);
+
+/** Counts a Timer0 overflow. Must be the first thing in the TIMER0_OVF interrupt. */
+#define PROFILE_OVERFLOW()		(profile_overflows++)
+
+/** Starts a probe. */
+#define PROFILE_BEGIN(probe)	uint16_t profile_start_##probe = profile_now()
+
+/** Ends a probe started in the same block and records its duration. */
+#define PROFILE_END(probe)		profile_record(probe, profile_now() - profile_start_##probe)
+
+/** Records the latency of a timer interrupt, from the count of its timer. Must come first. */
+#define PROFILE_LATENCY(probe, count)	profile_latency_record(probe, count)
+
+#else
+
+#define PROFILE_OVERFLOW()		((void) 0)
+#define PROFILE_BEGIN(probe)	((void) 0)
+#define PROFILE_END(probe)		((void) 0)
+#define PROFILE_LATENCY(probe, count)	((void) 0)
+
+#endif
+
+/** CPU cycles per profiler tick. */
+#define PROFILE_TICK_CYCLES		(TIMER0_CFG.div)
+
+#endif /* PROFILE_H_ */
@@ -0,0 +1,88 @@
+#include "Stack.h"
+
+#include <avr/io.h>
+
+#ifdef __AVR__
+
+/** End of .bss and top of the stack, from the linker script. */
+extern uint8_t _end;
+extern uint8_t __stack;
+
+/**
+ * Paints the free RAM with STACK_CANARY. Runs in .init1, before the stack pointer and the zero
+ * register are set up: written in assembly, as compiled code could rely on either.
+ */
+static void stack_paint() __attribute__((naked, used, section(".init1")));
+
+static void stack_paint() {
+	__asm__ volatile(
+		"    ldi r30, lo8(_end)\n"
+		"    ldi r31, hi8(_end)\n"
+		"    ldi r24, %0\n"
+		"    ldi r25, hi8(__stack)\n"
+		"    rjmp 2f\n"
+		"1:  st Z+, r24\n"
+		"2:  cpi r30, lo8(__stack)\n"
+		"    cpc r31, r25\n"
+		"    brlo 1b\n"
+		"    breq 1b\n"
+		:: "M" (STACK_CANARY));
+}
+
+uint16_t stack_free() {
+	return SP - (uintptr_t) &_end;
+}
+
+/** Smallest headroom found by stack_scan() and stack_headroom(), 0 before the first call. */
+static uint16_t lowest = 0;
+
+/** Bytes checked by the scan of stack_scan() in progress. */
+static uint16_t scanned = 0;
+
+uint16_t stack_headroom() {
+	const uint8_t* p = &_end;
+
+	while(p <= &__stack && *p == STACK_CANARY)
+		p++;
+
+	lowest = p - &_end;
+	return lowest;
+}
+
+uint16_t stack_scan() {
+	if(!lowest)
+		lowest = &__stack - &_end + 1;
+
+	const uint8_t* p = &_end + scanned;
+	for(uint8_t n = STACK_SCAN_STEP; n > 0; n--) {
+		if(scanned >= lowest || p > &__stack || *p != STACK_CANARY) {
+			// Scan ended: start again from .bss
+			if(scanned < lowest)
+				lowest = scanned;
+			scanned = 0;
+			break;
+		}
+		p++;
+		scanned++;
+	}
+
+	return lowest;
+}
+
+#else
+
+// Host build (hal/host): the stack isn't the firmware's, nothing to measure
+
+uint16_t stack_free() {
+	return 0;
+}
+
+uint16_t stack_headroom() {
+	return 0;
+}
+
+uint16_t stack_scan() {
+	return 0;
+}
+
+#endif
@@ -0,0 +1,43 @@
+/*! \file */
+
+#ifndef STACK_H_
+#define STACK_H_
+
+#include "../constants.h"
+
+#include <stdint.h>
+
+/*
+ * Stack high-water mark.
+ *
+ * Before the C runtime starts (.init1), the RAM between the end of .bss and the top of the stack
+ * is painted with STACK_CANARY. The stack grows down over it: the painted bytes left above .bss
+ * are the smallest headroom the stack ever had. A value equal to the canary pushed on the stack
+ * can only make the headroom look smaller by a byte or two.
+ */
+
+/** Value painted over the free RAM at startup. */
+#define STACK_CANARY	0xC5
+
+/**
+ * Returns the free RAM now, between the end of .bss and the stack pointer.
+ * \return bytes
+ */
+uint16_t stack_free();
+
+/**
+ * Returns the smallest free RAM since power up. Scans the painted bytes, a few cycles each.
+ * \return bytes
+ */
+uint16_t stack_headroom();
+
+/**
+ * Same, in steps for the main loop: checks up to STACK_SCAN_STEP more painted bytes, resuming
+ * where the last call stopped. A scan ends at the first byte overwritten or at the smallest
+ * headroom found before, as the headroom only shrinks. Until the first scan ends, all the
+ * painted RAM is free.
+ * \return bytes, smallest free RAM found by the scans ended
+ */
+uint16_t stack_scan();
+
+#endif /* STACK_H_ */
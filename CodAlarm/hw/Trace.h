@@ -0,0 +1,47 @@
+/*! \file */
+
+#ifndef TRACE_H_
+#define TRACE_H_
+
+#include "../constants.h"
+
+#include "Pin.h"
+
+/*
+ * Trace pins for a logic analyser, built in with TRACE set to 1 (see constants.h).
+ *
+ * Each channel is a pin, high while its section runs:
+ *
+ *     Isr       any interrupt
+ *     Frame     GUI::draw(), display update included
+ *     Update    Display::update(), while something is sent
+ *
+ * Interrupts don't nest, so Isr is high exactly while the CPU runs one (prologue and epilogue
+ * excluded). Frame and Update stay high when interrupted: Isr tells them apart. A transition is a
+ * single sbi or cbi instruction, 2 cycles. tools/sim records the same pins to a VCD file.
+ */
+
+#if TRACE
+
+typedef PIN_T(PORT_TRACE_ISR, LINE_TRACE_ISR)		PinTraceIsr;
+typedef PIN_T(PORT_TRACE_FRAME, LINE_TRACE_FRAME)	PinTraceFrame;
+typedef PIN_T(PORT_TRACE_UPDATE, LINE_TRACE_UPDATE)	PinTraceUpdate;
+
+/** Configures the trace pins as outputs, low. */
+#define TRACE_INIT()			do { PinTraceIsr::output(); PinTraceFrame::output(); PinTraceUpdate::output(); } while(0)
+
+/** Sets a channel high: Isr, Frame or Update. */
+#define TRACE_BEGIN(channel)	PinTrace##channel::set()
+
+/** Sets a channel low. */
+#define TRACE_END(channel)		PinTrace##channel::clear()
+
+#else
+
+#define TRACE_INIT()			((void) 0)
+#define TRACE_BEGIN(channel)	((void) 0)
+#define TRACE_END(channel)		((void) 0)
+
+#endif
+
+#endif /* TRACE_H_ */
@@ -0,0 +1,160 @@
+#include "Uart.h"
+
+#include <avr/pgmspace.h>
+#include <util/atomic.h>
+
+Uart::Uart() {
+    rx_head = 0;
+    rx_tail = 0;
+    tx_head = 0;
+    tx_tail = 0;
+    rx_lost = 0;
+    tx_lost = 0;
+}
+
+void Uart::init() {
+    PinBusDE::output();								// RS-485 driver off: listen only
+
+#if DISPLAY_LINK != DISPLAY_LINK_USART
+    // Otherwise the USART drives the display: no console, everything queued is dropped
+    UBRR0 = UART_UBRR;
+    UCSR0A = (1 << U2X0);							// Double speed: lower baud error at 1 MHz
+    UCSR0C = (1 << UCSZ01) | (1 << UCSZ00);			// 8 data bits, no parity, 1 stop bit
+    UCSR0B = (1 << RXCIE0) | (1 << RXEN0) | (1 << TXEN0);	// Enable receiver, its interrupt and transmitter
+#endif
+}
+
+bool Uart::put(char c) {
+    uint8_t next = (tx_head + 1) & (UART_TX_BUFFER - 1);
+
+    if(next == tx_tail || DISPLAY_LINK == DISPLAY_LINK_USART) {
+        // Full, or no console: never wait for the line
+        tx_lost++;
+        return false;
+    }
+
+    tx[tx_head] = c;
+    tx_head = next;
+
+    // Start sending, transmit() disables the interrupt when done
+    UCSR0B |= (1 << UDRIE0);
+    return true;
+}
+
+void Uart::print(const char* s) {
+    while(*s)
+        put(*s++);
+}
+
+void Uart::print_P(const char* s) {
+    char c;
+    while((c = pgm_read_byte(s++)))
+        put(c);
+}
+
+void Uart::printHex(uint16_t value) {
+    for(int8_t shift = 12; shift >= 0; shift -= 4) {
+        uint8_t digit = (value >> shift) & 0x0F;
+        put(digit < 10 ? '0' + digit : 'A' + digit - 10);
+    }
+}
+
+void Uart::printDec(uint16_t value) {
+    char digits[5];
+    uint8_t n = 0;
+
+    do {
+        digits[n++] = '0' + value % 10;
+        value /= 10;
+    } while(value);
+
+    while(n)
+        put(digits[--n]);
+}
+
+void Uart::print2(uint8_t value) {
+    put('0' + value / 10);
+    put('0' + value % 10);
+}
+
+bool Uart::idle() {
+    return tx_head == tx_tail;
+}
+
+void Uart::watchSent() {
+    // The USART_TX interrupt belongs to the display with its USART link
+    if(DISPLAY_LINK == DISPLAY_LINK_USART)
+        return;
+
+    // Clear an old completion (written one), keep the configuration bits
+    UCSR0A = (UCSR0A & (1 << U2X0)) | (1 << TXC0);
+    UCSR0B |= (1 << TXCIE0);
+}
+
+void Uart::drive() {
+    // Nothing is sent with the USART link of the display, nor would sent() release the bus
+    if(DISPLAY_LINK == DISPLAY_LINK_USART)
+        return;
+
+    PinBusDE::set();
+}
+
+uint8_t Uart::space() {
+    return (tx_tail - tx_head - 1) & (UART_TX_BUFFER - 1);
+}
+
+bool Uart::get(char* c) {
+    if(rx_tail == rx_head)
+        return false;
+
+    *c = rx[rx_tail];
+    rx_tail = (rx_tail + 1) & (UART_RX_BUFFER - 1);
+    return true;
+}
+
+uint16_t Uart::getRxLost() {
+    uint16_t lost;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        lost = rx_lost;
+    }
+    return lost;
+}
+
+uint16_t Uart::getTxLost() {
+    return tx_lost;
+}
+
+char Uart::receive() {
+    // Status must be read before the data
+    bool overrun = UCSR0A & (1 << DOR0);
+    char c = UDR0;
+    uint8_t next = (rx_head + 1) & (UART_RX_BUFFER - 1);
+
+    if(overrun)
+        rx_lost++;
+
+    if(next == rx_tail) {
+        rx_lost++;
+        return c;
+    }
+
+    rx[rx_head] = c;
+    rx_head = next;
+    return c;
+}
+
+void Uart::transmit() {
+    if(tx_tail == tx_head) {
+        // Nothing left to send
+        UCSR0B &= ~(1 << UDRIE0);
+        return;
+    }
+
+    UDR0 = tx[tx_tail];
+    tx_tail = (tx_tail + 1) & (UART_TX_BUFFER - 1);
+}
+
+void Uart::sent() {
+    UCSR0B &= ~(1 << TXCIE0);
+    PinBusDE::clear();
+}
@@ -0,0 +1,180 @@
+#ifndef UART_H_
+#define UART_H_
+
+#include "../constants.h"
+
+#include <avr/io.h>
+#include <stdint.h>
+
+#include "Pin.h"
+
+typedef PIN_T(PORT_BUS_DE, LINE_BUS_DE)	PinBusDE;
+
+/** UBRR0 value for UART_BAUD, double speed mode (U2X0). */
+constexpr uint16_t UART_UBRR = (F_CPU + 4UL * UART_BAUD) / (8UL * UART_BAUD) - 1;
+
+/** Baud rate error in parts per thousand. */
+constexpr int32_t UART_ERROR = ((int32_t) (F_CPU / (8UL * (UART_UBRR + 1))) - (int32_t) UART_BAUD) * 1000 / (int32_t) UART_BAUD;
+
+static_assert(UART_UBRR <= 4095, "Uart: UART_BAUD too low for F_CPU");
+static_assert(UART_ERROR <= 20 && UART_ERROR >= -20, "Uart: UART_BAUD can't be reached within 2% at this F_CPU");
+static_assert(UART_RX_BUFFER <= 256 && (UART_RX_BUFFER & (UART_RX_BUFFER - 1)) == 0, "Uart: UART_RX_BUFFER must be a power of 2");
+static_assert(UART_TX_BUFFER <= 256 && (UART_TX_BUFFER & (UART_TX_BUFFER - 1)) == 0, "Uart: UART_TX_BUFFER must be a power of 2");
+
+/**
+ * \brief Serial port wrapper (USART0, 8N1).
+ * Interrupt driven: received characters are queued by receive() (USART_RX interrupt) and sent
+ * characters by transmit() (USART_UDRE interrupt), so no method ever waits for the line. When a
+ * ring buffer is full the character is dropped and counted. Each buffer has a single producer
+ * and a single consumer, and 8-bit indexes are read atomically, so no interrupt is disabled.
+ * With the USART link of the display (DISPLAY_LINK) the USART is left to the display: nothing is
+ * received and every character is dropped.
+ */
+class Uart {
+
+public:
+    /**
+     * Class constructor.
+     * \return
+     */
+    Uart();
+
+    /**
+     * Initializes the USART at UART_BAUD and enables the receive interrupt.
+     * \return void
+     */
+    void init();
+
+    /**
+     * Queues a character to send.
+     * \param c character
+     * \return bool false if the transmit buffer is full and the character was dropped
+     */
+    bool put(char);
+
+    /**
+     * Queues a string.
+     * \param s null terminated string
+     * \return void
+     */
+    void print(const char*);
+
+    /**
+     * Queues a string stored in flash (PSTR()).
+     * \param s null terminated string in flash
+     * \return void
+     */
+    void print_P(const char*);
+
+    /**
+     * Queues a value as 4 hexadecimal digits.
+     * \param value value
+     * \return void
+     */
+    void printHex(uint16_t);
+
+    /**
+     * Queues a value in decimal.
+     * \param value value
+     * \return void
+     */
+    void printDec(uint16_t);
+
+    /**
+     * Queues a value as 2 decimal digits, zero padded.
+     * \param value value, 0 to 99
+     * \return void
+     */
+    void print2(uint8_t);
+
+    /**
+     * Returns whether everything queued was sent to the transmitter.
+     * \return bool true if the transmit buffer is empty
+     */
+    bool idle();
+
+    /**
+     * Enables the USART_TX interrupt, raised once the last queued character has left the
+     * transmitter. The interrupt must call sent().
+     * \return void
+     */
+    void watchSent();
+
+    /**
+     * Enables the RS-485 driver of the time bus until the end of the transmission: sent()
+     * disables it, so watchSent() must follow once everything is queued.
+     * \return void
+     */
+    void drive();
+
+    /**
+     * Returns the free space in the transmit buffer.
+     * \return number of characters that can be queued
+     */
+    uint8_t space();
+
+    /**
+     * Reads a received character, if any.
+     * \param c destination
+     * \return bool false if nothing was received
+     */
+    bool get(char*);
+
+    /**
+     * Returns the number of characters lost, received with a full buffer or overrun in hardware.
+     * \return count
+     */
+    uint16_t getRxLost();
+
+    /**
+     * Returns the number of characters dropped because the transmit buffer was full.
+     * \return count
+     */
+    uint16_t getTxLost();
+
+    /**
+     * Stores a received character. Must be called by the USART_RX interrupt.
+     * \return received character
+     */
+    char receive();
+
+    /**
+     * Sends the next queued character, or disables the interrupt once the queue is empty.
+     * Must be called by the USART_UDRE interrupt.
+     * \return void
+     */
+    void transmit();
+
+    /**
+     * Disables the USART_TX interrupt and the RS-485 driver. Must be called by the USART_TX interrupt.
+     * \return void
+     */
+    void sent();
+
+private:
+    /** Receive ring buffer. */
+    char rx[UART_RX_BUFFER];
+
+    /** Transmit ring buffer. */
+    char tx[UART_TX_BUFFER];
+
+    /** Next free position of rx, written by receive(). */
+    volatile uint8_t rx_head;
+
+    /** Next character of rx to read, written by get(). */
+    volatile uint8_t rx_tail;
+
+    /** Next free position of tx, written by put(). */
+    volatile uint8_t tx_head;
+
+    /** Next character of tx to send, written by transmit(). */
+    volatile uint8_t tx_tail;
+
+    /** Characters lost on receive. */
+    volatile uint16_t rx_lost;
+
+    /** Characters dropped on transmit. */
+    uint16_t tx_lost;
+};
+
+#endif /* UART_H_ */
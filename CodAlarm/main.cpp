@@ -1,10 +1,22 @@
+#include "constants.h"
+
 #include <avr/io.h>
 #include <avr/interrupt.h>
+#include <util/atomic.h>
 #include <util/delay.h>
 
 #include "core/Clock.h"
 #include "core/CodAlarm.h"
 #include "core/GUI.h"
+#include "core/Checkpoint.h"
+#include "core/Console.h"
+#include "core/EventLog.h"
+#include "core/Settings.h"
+#include "core/StateMachine.h"
+#include "core/Telemetry.h"
+#include "core/TimeSync.h"
+#include "hw/Profile.h"
+#include "hw/Trace.h"
 
 #define BACKLIGHT_OFF	-1
 #define BUZZER_OFF		-1
@@ -14,78 +26,121 @@
 //////////////////////////////////////////////////////////////////////////
 
 /**
- * Generic button short press, called for every button.
+ * Button handlers, bound to IO at compile time through the checkPress() and countCheckLong()
+ * template parameter.
+ */
+struct Buttons {
+	/**
+	 * Generic button short press, called for every button.
+	 * \return void
+	 */
+	static void pressAny();
+
+	/**
+	 * Button short press event handler.
+	 * \param button button
+	 * \return void
+	 */
+	static void press(t_button);
+
+	/**
+	 * Button long press event handler. Only called for the first N_PRESSEVENTS_LONG buttons.
+	 * \param button button
+	 * \return void
+	 */
+	static void longPress(t_button);
+};
+
+/**
+ * Initializes the hardware wrappers, restores the saved state and starts the timers and interrupts.
  * \return void
  */
-void pressButton();
+void setup();
 
 /**
- * "Set Alarm" short press event handler.
+ * One pass of the main loop: switch, buttons, background saves, serial line and display.
+ * main() calls it forever; host simulations call it between the interrupts they play.
  * \return void
  */
-void pressSetAlarm();
+void loop();
 
 /**
- * "Set Alarm" long press event handler.
+ * Starts the buzzer by enabling Timer 2 compare interrupt. If the system is
+ * in the RING state, the buzzer rings intermittently until stopped (using switch or stop button),
+ * otherwise produces a single beep.
  * \return void
  */
-void longSetAlarm();
+void startBuzzer();
 
 /**
- * "Set Clock" short press event handler.
+ * Stops the buzzer by disabling Timer 2 compare interrupt.
  * \return void
  */
-void pressSetClock();
+void stopBuzzer();
 
 /**
- * "Set Clock" long press event handler.
+ * Sends an event to the state machine.
+ * \param event event
  * \return void
  */
-void longSetClock();
+void dispatch(t_event);
 
 /**
- * "Stop Alarm" short press event handler.
+ * Action: the alarm starts ringing.
  * \return void
  */
-void pressStopAlarm();
+void actRing();
 
 /**
- * "Up" short press event handler.
+ * Action: the alarm stops ringing, snooze is cancelled.
  * \return void
  */
-void pressUp();
+void actStop();
 
 /**
- * "Down" short press event handler.
+ * Action: the alarm stops ringing because the switch was turned off.
  * \return void
  */
-void pressDown();
+void actSwitchOff();
 
 /**
- * "Mode" short press event handler.
+ * Action: the alarm stops ringing and is postponed by 5 minutes.
  * \return void
  */
-void pressMode();
+void actSnooze();
 
 /**
- * "Snooze" short press event handler.
+ * Action: a pending snooze is cancelled.
  * \return void
  */
-void pressSnooze();
+void actCancelSnooze();
 
 /**
- * Starts the buzzer by enabling Timer 2 compare interrupt. If the system is
- * in the RING state, the buzzer rings intermittently until stopped (using switch or stop button),
- * otherwise produces a single beep.
+ * Changes the clock as set by the user.
+ * \param hours hours to add
+ * \param minutes minutes to add
  * \return void
  */
-void startBuzzer();
+void actClockSet(int, int);
 
 /**
- * Stops the buzzer by disabling Timer 2 compare interrupt.
+ * Action: the user stops setting the clock.
  * \return void
  */
-void stopBuzzer();
+void actClockDone();
+
+/**
+ * Actions: the clock or the alarm hours and minutes are increased/decreased by one.
+ * \return void
+ */
+void actClockHourUp();
+void actClockHourDown();
+void actClockMinUp();
+void actClockMinDown();
+void actAlarmHourUp();
+void actAlarmHourDown();
+void actAlarmMinUp();
+void actAlarmMinDown();
 
 //////////////////////////////////////////////////////////////////////////
 // GLOBALS
@@ -93,6 +148,12 @@ void stopBuzzer();
 
 CodAlarm ca;
 GUI gui(&ca);
+Settings settings(&ca);
+Checkpoint checkpoint(&ca);
+EventLog eventlog(&ca);
+Telemetry telemetry(&ca, &gui, &eventlog);
+TimeSync timesync(&ca, &checkpoint, &eventlog);
+Console console(&ca, &checkpoint, &eventlog, &telemetry, &timesync);
 
 /** Stores the countdown used for disabling the backlight. */
 int backlight_counter = BACKLIGHT_OFF;
@@ -103,69 +164,176 @@ int buzzer_counter	  = BUZZER_OFF;
 /** Used to make the intermittent beep of the alarm ringing. */
 bool buzzer_state = false;
 
+/** True if the clock was changed since entering SET_CLOCK1. */
+bool clock_changed = false;
+
+/**
+ * State machine transition table, stored in flash. One row per state and event pair, in
+ * the order of t_state and t_event.
+ */
+constexpr t_transition transitions[] PROGMEM = {
+	//         state       event              action            next
+	TRANSITION(IDLE,       EV_SET_ALARM,      NULL,             IDLE),
+	TRANSITION(IDLE,       EV_SET_ALARM_LONG, NULL,             SET_ALARM1),
+	TRANSITION(IDLE,       EV_SET_CLOCK,      NULL,             IDLE),
+	TRANSITION(IDLE,       EV_SET_CLOCK_LONG, NULL,             SET_CLOCK1),
+	TRANSITION(IDLE,       EV_STOP_ALARM,     NULL,             IDLE),
+	TRANSITION(IDLE,       EV_UP,             NULL,             IDLE),
+	TRANSITION(IDLE,       EV_DOWN,           NULL,             IDLE),
+	TRANSITION(IDLE,       EV_SNOOZE,         NULL,             IDLE),
+	TRANSITION(IDLE,       EV_SWITCH_OFF,     actCancelSnooze,  IDLE),
+	TRANSITION(IDLE,       EV_ALARM,          actRing,          RING),
+
+	TRANSITION(SET_CLOCK1, EV_SET_ALARM,      actClockDone,     IDLE),
+	TRANSITION(SET_CLOCK1, EV_SET_ALARM_LONG, NULL,             SET_CLOCK1),
+	TRANSITION(SET_CLOCK1, EV_SET_CLOCK,      NULL,             SET_CLOCK2),
+	TRANSITION(SET_CLOCK1, EV_SET_CLOCK_LONG, NULL,             SET_CLOCK1),
+	TRANSITION(SET_CLOCK1, EV_STOP_ALARM,     NULL,             SET_CLOCK1),
+	TRANSITION(SET_CLOCK1, EV_UP,             actClockHourUp,   SET_CLOCK1),
+	TRANSITION(SET_CLOCK1, EV_DOWN,           actClockHourDown, SET_CLOCK1),
+	TRANSITION(SET_CLOCK1, EV_SNOOZE,         NULL,             SET_CLOCK1),
+	TRANSITION(SET_CLOCK1, EV_SWITCH_OFF,     actCancelSnooze,  SET_CLOCK1),
+	TRANSITION(SET_CLOCK1, EV_ALARM,          NULL,             SET_CLOCK1),
+
+	TRANSITION(SET_CLOCK2, EV_SET_ALARM,      actClockDone,     IDLE),
+	TRANSITION(SET_CLOCK2, EV_SET_ALARM_LONG, NULL,             SET_CLOCK2),
+	TRANSITION(SET_CLOCK2, EV_SET_CLOCK,      actClockDone,     IDLE),
+	TRANSITION(SET_CLOCK2, EV_SET_CLOCK_LONG, NULL,             SET_CLOCK2),
+	TRANSITION(SET_CLOCK2, EV_STOP_ALARM,     NULL,             SET_CLOCK2),
+	TRANSITION(SET_CLOCK2, EV_UP,             actClockMinUp,    SET_CLOCK2),
+	TRANSITION(SET_CLOCK2, EV_DOWN,           actClockMinDown,  SET_CLOCK2),
+	TRANSITION(SET_CLOCK2, EV_SNOOZE,         NULL,             SET_CLOCK2),
+	TRANSITION(SET_CLOCK2, EV_SWITCH_OFF,     actCancelSnooze,  SET_CLOCK2),
+	TRANSITION(SET_CLOCK2, EV_ALARM,          NULL,             SET_CLOCK2),
+
+	TRANSITION(SET_ALARM1, EV_SET_ALARM,      NULL,             SET_ALARM2),
+	TRANSITION(SET_ALARM1, EV_SET_ALARM_LONG, NULL,             SET_ALARM1),
+	TRANSITION(SET_ALARM1, EV_SET_CLOCK,      NULL,             IDLE),
+	TRANSITION(SET_ALARM1, EV_SET_CLOCK_LONG, NULL,             SET_ALARM1),
+	TRANSITION(SET_ALARM1, EV_STOP_ALARM,     NULL,             SET_ALARM1),
+	TRANSITION(SET_ALARM1, EV_UP,             actAlarmHourUp,   SET_ALARM1),
+	TRANSITION(SET_ALARM1, EV_DOWN,           actAlarmHourDown, SET_ALARM1),
+	TRANSITION(SET_ALARM1, EV_SNOOZE,         NULL,             SET_ALARM1),
+	TRANSITION(SET_ALARM1, EV_SWITCH_OFF,     actCancelSnooze,  SET_ALARM1),
+	TRANSITION(SET_ALARM1, EV_ALARM,          NULL,             SET_ALARM1),
+
+	TRANSITION(SET_ALARM2, EV_SET_ALARM,      NULL,             IDLE),
+	TRANSITION(SET_ALARM2, EV_SET_ALARM_LONG, NULL,             SET_ALARM2),
+	TRANSITION(SET_ALARM2, EV_SET_CLOCK,      NULL,             IDLE),
+	TRANSITION(SET_ALARM2, EV_SET_CLOCK_LONG, NULL,             SET_ALARM2),
+	TRANSITION(SET_ALARM2, EV_STOP_ALARM,     NULL,             SET_ALARM2),
+	TRANSITION(SET_ALARM2, EV_UP,             actAlarmMinUp,    SET_ALARM2),
+	TRANSITION(SET_ALARM2, EV_DOWN,           actAlarmMinDown,  SET_ALARM2),
+	TRANSITION(SET_ALARM2, EV_SNOOZE,         NULL,             SET_ALARM2),
+	TRANSITION(SET_ALARM2, EV_SWITCH_OFF,     actCancelSnooze,  SET_ALARM2),
+	TRANSITION(SET_ALARM2, EV_ALARM,          NULL,             SET_ALARM2),
+
+	TRANSITION(RING,       EV_SET_ALARM,      NULL,             RING),
+	TRANSITION(RING,       EV_SET_ALARM_LONG, NULL,             RING),
+	TRANSITION(RING,       EV_SET_CLOCK,      NULL,             RING),
+	TRANSITION(RING,       EV_SET_CLOCK_LONG, NULL,             RING),
+	TRANSITION(RING,       EV_STOP_ALARM,     actStop,          IDLE),
+	TRANSITION(RING,       EV_UP,             NULL,             RING),
+	TRANSITION(RING,       EV_DOWN,           NULL,             RING),
+	TRANSITION(RING,       EV_SNOOZE,         actSnooze,        IDLE),
+	TRANSITION(RING,       EV_SWITCH_OFF,     actSwitchOff,     IDLE),
+	TRANSITION(RING,       EV_ALARM,          NULL,             RING),
+};
+
+static_assert(fsm_check(transitions, sizeof(transitions) / sizeof(transitions[0])),
+		"transitions: missing, unsorted or invalid row");
+
 //////////////////////////////////////////////////////////////////////////
 // MAIN
 //////////////////////////////////////////////////////////////////////////
 
+#ifdef __AVR__
 int main(void) {
+	setup();
+
+	while (1)
+		loop();
+}
+#endif
+
+void setup() {
+	
+	// Keep the reset cause (brown-out, power-on, ...) and clear it for the next reset
+	uint8_t reset_cause = MCUSR;
+	MCUSR = 0;
 	
     // Initialize IO wrappers
     ca.io.init();
     ca.display.init();
+    ca.uart.init();
+    TRACE_INIT();
+	
+	// Restore saved settings and last known time
+	settings.load();
+	checkpoint.restore(reset_cause);
+	eventlog.init();
 	
 	// Configure Timer 0: Fast counter
 	TCNT0 = 0;					// Set timer to 0
 	TIMSK0 |= (1 << TOIE0); 	// enable overflow interrupt
-	TCCR0B |= (1 << CS01);		// Start timer at 1/8
+	TCCR0B |= TIMER0_CFG.cs;	// Start timer, prescaler chosen in timers.h
 
     // Configure Timer 1: 1Hz
     TCNT1 = 0;								// Set timer to 0
     TCCR1B |= (1 << WGM12);					// Configure for CTC mode
     TIMSK1 |= (1 << OCIE1A);				// Enable CTC interrupt
-    OCR1A  = TIMER1_CMP;					// Set CTC compare value to 1Hz at 1MHz AVR clock, with a prescaler of 64
-    TCCR1B |= (1 << CS10) | (1 << CS11);	// Start timer at 1/64
+    OCR1A  = TIMER1_CMP;					// Set CTC compare value to TIMER1_HZ
+    TCCR1B |= TIMER1_CFG.cs;				// Start timer, prescaler chosen in timers.h
 	
 	// Configure Timer 2: Buzzer
 	TCNT2 = 0;					// Set timer to 0
-    TCCR2B |= (1 << WGM12);		// Configure for CTC mode
-	OCR2A  = TIMER2_CMP;
-	TCCR2B |= (1 << CS01);		// Start timer at 1/8
-
-    // Configure button handlers
-	ca.io.setPressHandler(pressButton);
-	
-    ca.io.setPressHandler(SET_ALARM, pressSetAlarm);
-    ca.io.setPressHandler(SET_ALARM, pressSetClock);
-    ca.io.setPressHandler(UP, pressUp);
-    ca.io.setPressHandler(DOWN, pressDown);
-    ca.io.setPressHandler(MODE, pressMode);
-    ca.io.setPressHandler(SNOOZE, pressSnooze);
-	ca.io.setPressHandler(STOP_ALARM, pressStopAlarm);
-	
-    ca.io.setLongHandler(SET_ALARM, longSetAlarm);
-    ca.io.setLongHandler(SET_ALARM, longSetClock);
+    TCCR2A |= (1 << WGM21);		// Configure for CTC mode
+	OCR2A  = TIMER2_CMP;		// Set CTC compare value to twice BUZZER_HZ
+	TCCR2B |= TIMER2_CFG.cs;	// Start timer, prescaler chosen in timers.h
 
     sei();	// Turn on interrupts
+}
 
-    while (1) {
-
-        // Switch off ringing alarm
-        if(!ca.io.getSwitch()) {
-            // Switch set on "Alarm off"
-            if (ca.state = RING) {
-                ca.state = IDLE;
-                ca.snoozed = false;
-				
-				stopBuzzer(); // Stop buzzing
-            }
-        }
-		
-		// Check if any button was pressed
-		ca.io.checkPress();		// Calls handler if so...
+void loop() {
+    uint16_t loop_start, loop_end;
 
-        // Draw display
-        gui.draw();
+    // 16-bit timer reads share a temporary register with the Timer1 interrupt
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        loop_start = TCNT1;
     }
+
+    // Switch off ringing alarm
+    if(!ca.io.getSwitch()) {
+        // Switch set on "Alarm off"
+        dispatch(EV_SWITCH_OFF);
+    }
+	
+	// Check if any button was pressed
+	ca.io.checkPress<Buttons>();		// Calls handler if so...
+
+    // Save settings once stable, and clock periodically
+    settings.poll();
+    checkpoint.poll();
+    eventlog.poll();
+
+    // Serial console commands, telemetry and time requests, one at a time on the line
+    if(!telemetry.busy() && !timesync.busy())
+        console.poll();
+    if(!console.busy() && !timesync.busy())
+        telemetry.poll();
+    if(!console.busy() && !telemetry.busy())
+        timesync.poll();
+
+    // Draw display
+    gui.draw();
+
+    // Loop duration, Timer1 wraps every second
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        loop_end = TCNT1;
+    }
+    if(loop_end < loop_start)
+        loop_end += TIMER1_CMP + 1;
+    telemetry.loop(loop_end - loop_start);
 }
 
 
@@ -182,11 +350,16 @@ int main(void) {
  */
 ISR(TIMER0_OVF_vect)
 {			
+	TRACE_BEGIN(Isr);
+	PROFILE_LATENCY(PROBE_TIMER0, TCNT0);
+	PROFILE_OVERFLOW();
+	PROFILE_BEGIN(PROBE_TIMER0);
+	
 	// Check long press
-	ca.io.countCheckLong();
+	ca.io.countCheckLong<Buttons>();
 		
 	// Check display backlight
-	if(backlight_counter != BACKLIGHT_OFF)
+	if(backlight_counter != BACKLIGHT_OFF){
 		if(backlight_counter > 0){
 			// Decrease backlight counter
 			backlight_counter--;
@@ -194,8 +367,9 @@ ISR(TIMER0_OVF_vect)
 			ca.io.setLight(false);
 			backlight_counter = BACKLIGHT_OFF;
 		}
+	}
 		
-	if(buzzer_counter != BUZZER_OFF)
+	if(buzzer_counter != BUZZER_OFF){
 		if(buzzer_counter > 0){
 			// Decrease backlight counter
 			buzzer_counter--;
@@ -210,7 +384,7 @@ ISR(TIMER0_OVF_vect)
 					buzzer_counter = N_BUZZER_LONG;
 					stopBuzzer();
 				}
-				buzzer_state != buzzer_state;
+				buzzer_state = !buzzer_state;
 			}else{
 				// Not ringing, stop here
 				buzzer_counter = BUZZER_OFF;
@@ -218,53 +392,139 @@ ISR(TIMER0_OVF_vect)
 				stopBuzzer();
 			}
 		}
+	}
+	
+	// Time since overflow
+	telemetry.isrTimer0(TCNT0);
+	
+	PROFILE_END(PROBE_TIMER0);
+	TRACE_END(Isr);
 }
 
 /**
  * Timer1 compare interrupt. Used to:
+ * - Set the length of the next second (time synchronisation)
  * - Count seconds
  * - Enable ringing
  * \return void
  */
 ISR(TIMER1_COMPA_vect) {
+    TRACE_BEGIN(Isr);
+    PROFILE_LATENCY(PROBE_TIMER1, TCNT1);
+    PROFILE_BEGIN(PROBE_TIMER1);
+
+    // Length of the next second, while Timer1 is low
+    timesync.tick();
+
     // Count seconds
     ca.clock.tick();
+	settings.tick();
+	checkpoint.tick();
+	eventlog.tick();
+	telemetry.tick();
 
     // Check alarm/snooze
     if(ca.io.getSwitch()) {
-        // Switch set on "Alarm on"
-        if (ca.state = IDLE) {
-            if(ca.snoozed) {
-                // Snoozed once
-                if(ca.snooze.getValue() == ca.clock.getValue()) {
-                    ca.state = RING;
-					startBuzzer();
-                }
-            } else {
-                // Never pressed snooze
-                if(ca.alarm.getValue() == ca.clock.getValue()) {
-                    ca.state = RING;
-					startBuzzer();
-                }
-            }
+        // Switch set on "Alarm on": snoozed alarms ring at the snooze time
+        Clock& due = ca.snoozed ? ca.snooze : ca.alarm;
+
+        if(due.getValue() == ca.clock.getValue()) {
+            dispatch(EV_ALARM);
         }
     }
+
+    // Time since compare match
+    telemetry.isrTimer1(TCNT1);
+
+    PROFILE_END(PROBE_TIMER1);
+    TRACE_END(Isr);
+}
+
+/**
+ * EEPROM ready interrupt. Used to write settings in background.
+ * \return void
+ */
+ISR(EE_READY_vect) {
+	TRACE_BEGIN(Isr);
+	ca.eeprom.ready();
+	TRACE_END(Isr);
+}
+
+#if DISPLAY_LINK == DISPLAY_LINK_USART
+
+/**
+ * USART data register empty interrupt. Used to send the display bytes.
+ * \return void
+ */
+ISR(USART_UDRE_vect) {
+	TRACE_BEGIN(Isr);
+	DisplayUsart::transmit();
+	TRACE_END(Isr);
+}
+
+/**
+ * USART transmit complete interrupt. Used to change the display A0 line between bytes.
+ * \return void
+ */
+ISR(USART_TX_vect) {
+	TRACE_BEGIN(Isr);
+	DisplayUsart::sent();
+	TRACE_END(Isr);
+}
+
+#else
+
+/**
+ * USART receive complete interrupt. Used to queue console input.
+ * \return void
+ */
+ISR(USART_RX_vect) {
+	TRACE_BEGIN(Isr);
+	// Frame delimiters are timestamped for time synchronisation
+	if(ca.uart.receive() == 0)
+		timesync.delimiter();
+	TRACE_END(Isr);
+}
+
+/**
+ * USART data register empty interrupt. Used to send console output.
+ * \return void
+ */
+ISR(USART_UDRE_vect) {
+	TRACE_BEGIN(Isr);
+	ca.uart.transmit();
+	TRACE_END(Isr);
+}
+
+/**
+ * USART transmit complete interrupt. Used to timestamp the end of time requests.
+ * \return void
+ */
+ISR(USART_TX_vect) {
+	TRACE_BEGIN(Isr);
+	ca.uart.sent();
+	timesync.sent();
+	TRACE_END(Isr);
 }
 
+#endif
+
 /**
  * Timer2 compare interrupt. Used to create the buzzing sound.
  * \return void
  */
 ISR(TIMER2_COMPA_vect) {
+	TRACE_BEGIN(Isr);
 	// Bzzzzzzzzzzzzzzzzzzzzzzzzzzzzzz!!!!!
 	ca.io.buzz();
+	TRACE_END(Isr);
 }
 
 //////////////////////////////////////////////////////////////////////////
 // BUTTON HANDLERS
 //////////////////////////////////////////////////////////////////////////
 
-void pressButton() {
+void Buttons::pressAny() {
 	// Generic short press
 	ca.io.setLight(true);
 	backlight_counter = N_BACKLIGHT;
@@ -272,124 +532,126 @@ void pressButton() {
 	startBuzzer();
 }
 
-void pressStopAlarm() {
-	// Generic short press
-	if (ca.state = RING) {
-		// Only if it's ringing
-		ca.state = IDLE;
-		ca.snoozed = false;
-		            
-		stopBuzzer(); // Stop buzzing
+void Buttons::press(t_button button) {
+	switch (button) {
+	case SET_ALARM:
+		dispatch(EV_SET_ALARM);
+		break;
+
+	case SET_CLOCK:
+		dispatch(EV_SET_CLOCK);
+		break;
+
+	case STOP_ALARM:
+		dispatch(EV_STOP_ALARM);
+		break;
+
+	case UP:
+		dispatch(EV_UP);
+		break;
+
+	case DOWN:
+		dispatch(EV_DOWN);
+		break;
+
+	case MODE:
+		// Not a state change
+		if(ca.mode == H12) {
+			ca.mode = H24;
+		} else {
+			ca.mode = H12;
+		}
+		break;
+
+	case SNOOZE:
+		dispatch(EV_SNOOZE);
+		break;
 	}
 }
 
-void pressSetAlarm() {
-    // Short press
-    if(ca.state == SET_ALARM1) {
-        ca.state = SET_ALARM2;
-    } else {
-        ca.state = IDLE;
-    }
-}
+void Buttons::longPress(t_button button) {
+	switch (button) {
+	case SET_ALARM:
+		dispatch(EV_SET_ALARM_LONG);
+		break;
 
-void longSetAlarm() {
-    // Long press
-    if(ca.state == IDLE) {
-        ca.state = SET_ALARM1;
-    }
+	case SET_CLOCK:
+		dispatch(EV_SET_CLOCK_LONG);
+		break;
+
+	default:
+		// No long press event
+		break;
+	}
 }
 
-void pressSetClock() {
-    // Short press
-    if(ca.state == SET_CLOCK1) {
-        ca.state = SET_CLOCK2;
-    } else {
-        ca.state = IDLE;
-    }
+//////////////////////////////////////////////////////////////////////////
+// STATE MACHINE ACTIONS
+//////////////////////////////////////////////////////////////////////////
 
+void dispatch(t_event event) {
+	fsm_dispatch(transitions, ca.state, event);
 }
 
-void longSetClock() {
-    // Long press
-    if(ca.state == IDLE) {
-        ca.state = SET_CLOCK1;
-    }
+void actRing() {
+	startBuzzer();
+	eventlog.log(LOG_ALARM);
 }
 
-void pressUp() {
-    switch (ca.state) {
-    case SET_ALARM1:
-        ca.alarm.setHour(1);
-        break;
-
-    case SET_ALARM2:
-        ca.alarm.setMin(1);
-        break;
-
-    case SET_CLOCK1:
-        ca.clock.setHour(1);
-        break;
-
-    case SET_CLOCK2:
-        ca.clock.setMin(1);
-        break;
-
-    default:
-        // Nothing!
-        break;
-    }
+void actStop() {
+	ca.snoozed = false;
+	stopBuzzer(); // Stop buzzing
+	eventlog.log(LOG_STOP);
 }
 
-void pressDown() {
-    switch (ca.state) {
-    case SET_ALARM1:
-        ca.alarm.setHour(-1);
-        break;
-
-    case SET_ALARM2:
-        ca.alarm.setMin(-1);
-        break;
-
-    case SET_CLOCK1:
-        ca.clock.setHour(-1);
-        break;
-
-    case SET_CLOCK2:
-        ca.clock.setMin(-1);
-        break;
+void actSwitchOff() {
+	ca.snoozed = false;
+	stopBuzzer(); // Stop buzzing
+	eventlog.log(LOG_SWITCH_OFF);
+}
 
-    default:
-        // Nothing!
-        break;
-    }
+void actSnooze() {
+	if (!ca.snoozed) {
+		// First snooze
+		ca.snoozed = true;			// No longer first snooze
+		ca.snooze.sync(ca.alarm);	// Start from alarm value...
+		ca.snooze.setMin(5);		// ... 5 more minutes Mom
+	} else {
+		// More than 1 snooze
+		ca.snooze.setMin(5);
+	}
+	eventlog.log(LOG_SNOOZE);
 }
 
-void pressMode() {
-    if(ca.mode == H12) {
-        ca.mode = H24;
-    } else {
-        ca.mode = H12;
-    }
+void actCancelSnooze() {
+	ca.snoozed = false;
 }
 
-void pressSnooze() {
-    if(ca.state == RING) {
-        // Only if ringing
-        if (!ca.snoozed) {
-            // First snooze
-            ca.snoozed = true;			// No longer first snooze
-            ca.snooze.sync(ca.alarm);	// Start from alarm value...
-            ca.snooze.setMin(5);		// ... 5 more minutes Mom
-        } else {
-            // More than 1 snooze
-            ca.snooze.setMin(5);
-        }
+void actClockSet(int hours, int minutes) {
+	ca.clock.setHour(hours);
+	ca.clock.setMin(minutes);
+	
+	// Set by the user: no longer stale, save it
+	ca.stale = false;
+	clock_changed = true;
+	checkpoint.request();
+}
 
-        // Stop ringing
-        ca.state = IDLE;
-    }
+void actClockDone() {
+	if(clock_changed)
+		eventlog.logTime(LOG_TIME_SET);
+	clock_changed = false;
 }
 
+void actClockHourUp()	{ actClockSet(1, 0); }
+void actClockHourDown()	{ actClockSet(-1, 0); }
+void actClockMinUp()	{ actClockSet(0, 1); }
+void actClockMinDown()	{ actClockSet(0, -1); }
+void actAlarmHourUp()	{ ca.alarm.setHour(1); }
+void actAlarmHourDown()	{ ca.alarm.setHour(-1); }
+void actAlarmMinUp()	{ ca.alarm.setMin(1); }
+void actAlarmMinDown()	{ ca.alarm.setMin(-1); }
+
 //////////////////////////////////////////////////////////////////////////
 // FUNCTIONS
 //////////////////////////////////////////////////////////////////////////
@@ -406,10 +668,10 @@ void startBuzzer(){
 		buzzer_counter = N_BUZZER_SHORT;
 	}
 	// Activate interrupt
-	TIMSK2 = SET_BIT(TIMSK2, OCIE1A);	// Enable Timer2 CTC interrupt
+	TIMSK2 = SET_BIT(TIMSK2, OCIE2A);	// Enable Timer2 CTC interrupt
 }
 	
 void stopBuzzer(){
 	// Disable interrupt
-	TIMSK2 = UNSET_BIT(TIMSK2, OCIE1A);	// Enable Timer2 CTC interrupt
+	TIMSK2 = UNSET_BIT(TIMSK2, OCIE2A);	// Disable Timer2 CTC interrupt
 }
\ No newline at end of file
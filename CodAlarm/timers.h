@@ -0,0 +1,177 @@
+/*! \file */
+
+#ifndef TIMERS_H_
+#define TIMERS_H_
+
+#include <stdint.h>
+
+//////////////////////////////////////////////////////////////////////////
+// TYPES
+//////////////////////////////////////////////////////////////////////////
+
+/** Prescaler option of a timer: division factor and CSn2:0 clock select bits. */
+struct t_prescaler {
+	/** Clock division factor. */
+	uint16_t div;
+	/** Value of the CSn2:0 bits selecting this division. */
+	uint8_t cs;
+};
+
+/** Timer configuration computed at compile time. */
+struct t_timer {
+	/** Index of the chosen prescaler, -1 if no prescaler can satisfy the request. */
+	int8_t index;
+	/** Clock division factor. */
+	uint16_t div;
+	/** Value of the CSn2:0 bits, to be ORed in TCCRnB. */
+	uint8_t cs;
+	/** Compare value (CTC mode). Unused in overflow mode. */
+	uint32_t top;
+	/** Interrupt period in nanoseconds. */
+	uint32_t period_ns;
+	/** Frequency error in parts per million against the requested one. */
+	int32_t error_ppm;
+};
+
+//////////////////////////////////////////////////////////////////////////
+// PRESCALERS
+//////////////////////////////////////////////////////////////////////////
+
+/** Number of prescalers available on Timer0 and Timer1. */
+#define N_PRESCALERS_T01	5
+
+/** Number of prescalers available on Timer2. */
+#define N_PRESCALERS_T2		7
+
+/** Timer0 and Timer1 prescalers, sorted by division. */
+constexpr t_prescaler PRESCALERS_T01[N_PRESCALERS_T01] = {
+	{1, 1}, {8, 2}, {64, 3}, {256, 4}, {1024, 5}
+};
+
+/** Timer2 prescalers, sorted by division. */
+constexpr t_prescaler PRESCALERS_T2[N_PRESCALERS_T2] = {
+	{1, 1}, {8, 2}, {32, 3}, {64, 4}, {128, 5}, {256, 6}, {1024, 7}
+};
+
+//////////////////////////////////////////////////////////////////////////
+// FUNCTIONS
+//////////////////////////////////////////////////////////////////////////
+
+/**
+ * Computes a CTC compare value, rounded to the nearest count.
+ * \param f_cpu CPU clock in Hz
+ * \param div prescaler division
+ * \param hz requested interrupt frequency in Hz
+ * \return compare value (OCRnA)
+ */
+constexpr uint32_t timer_top(uint32_t f_cpu, uint16_t div, uint32_t hz) {
+	return (f_cpu + (uint32_t) div * hz / 2) / ((uint32_t) div * hz) - 1;
+}
+
+/**
+ * Computes the frequency error of a CTC configuration.
+ * \param f_cpu CPU clock in Hz
+ * \param div prescaler division
+ * \param top compare value
+ * \param hz requested interrupt frequency in Hz
+ * \return error in parts per million, positive if faster than requested
+ */
+constexpr int32_t timer_error_ppm(uint32_t f_cpu, uint16_t div, uint32_t top, uint32_t hz) {
+	return (int32_t) (((int64_t) f_cpu - (int64_t) div * (top + 1) * hz) * 1000000
+			/ ((int64_t) div * (top + 1) * hz));
+}
+
+/**
+ * Chooses the smallest prescaler whose compare value fits the timer, which gives
+ * the finest resolution and the smallest rounding error.
+ * \param f_cpu CPU clock in Hz
+ * \param table prescalers of the timer
+ * \param n number of prescalers
+ * \param hz requested interrupt frequency in Hz
+ * \param max_top largest compare value (0xFF or 0xFFFF)
+ * \return timer configuration, index is -1 if hz can't be reached
+ */
+constexpr t_timer timer_ctc(uint32_t f_cpu, const t_prescaler* table, uint8_t n, uint32_t hz, uint32_t max_top) {
+	for(uint8_t i = 0; i < n; i++) {
+		uint32_t top = timer_top(f_cpu, table[i].div, hz);
+		if(top >= 1 && top <= max_top) {
+			return t_timer { (int8_t) i, table[i].div, table[i].cs, top,
+				(uint32_t) ((uint64_t) table[i].div * (top + 1) * 1000000000 / f_cpu),
+				timer_error_ppm(f_cpu, table[i].div, top, hz) };
+		}
+	}
+	return t_timer { -1, 0, 0, 0, 0, 0 };
+}
+
+/**
+ * Chooses the smallest prescaler whose overflow period is at least the requested one.
+ * \param f_cpu CPU clock in Hz
+ * \param table prescalers of the timer
+ * \param n number of prescalers
+ * \param min_period_ns shortest acceptable overflow period in nanoseconds
+ * \param counts counts per overflow (256 for an 8-bit timer)
+ * \return timer configuration, index is -1 if no prescaler is slow enough
+ */
+constexpr t_timer timer_ovf(uint32_t f_cpu, const t_prescaler* table, uint8_t n, uint32_t min_period_ns, uint32_t counts) {
+	for(uint8_t i = 0; i < n; i++) {
+		uint32_t period = (uint32_t) ((uint64_t) table[i].div * counts * 1000000000 / f_cpu);
+		if(period >= min_period_ns) {
+			return t_timer { (int8_t) i, table[i].div, table[i].cs, counts - 1, period, 0 };
+		}
+	}
+	return t_timer { -1, 0, 0, 0, 0, 0 };
+}
+
+/**
+ * Converts a duration to a number of timer interrupts, rounded to the nearest.
+ * \param ms duration in milliseconds
+ * \param timer timer configuration
+ * \return number of interrupts
+ */
+constexpr uint32_t timer_count(uint32_t ms, t_timer timer) {
+	return ((uint64_t) ms * 1000000 + timer.period_ns / 2) / timer.period_ns;
+}
+
+/**
+ * Returns the error of a duration converted by timer_count().
+ * \param ms duration in milliseconds
+ * \param timer timer configuration
+ * \return error in parts per thousand
+ */
+constexpr int32_t timer_count_error(uint32_t ms, t_timer timer) {
+	return (int32_t) (((int64_t) timer_count(ms, timer) * timer.period_ns - (int64_t) ms * 1000000) * 1000
+			/ ((int64_t) ms * 1000000));
+}
+
+//////////////////////////////////////////////////////////////////////////
+// CONFIGURATION
+//////////////////////////////////////////////////////////////////////////
+
+/** Timer0: free running, overflow interrupt used as the fast counter. */
+constexpr t_timer TIMER0_CFG = timer_ovf(F_CPU, PRESCALERS_T01, N_PRESCALERS_T01, TIMER0_PERIOD_US * 1000UL, 256);
+
+/** Timer1: CTC mode, compare interrupt every second. */
+constexpr t_timer TIMER1_CFG = timer_ctc(F_CPU, PRESCALERS_T01, N_PRESCALERS_T01, TIMER1_HZ, 0xFFFF);
+
+/** Timer2: CTC mode, compare interrupt toggles the buzzer, twice per period of the tone. */
+constexpr t_timer TIMER2_CFG = timer_ctc(F_CPU, PRESCALERS_T2, N_PRESCALERS_T2, 2 * BUZZER_HZ, 0xFF);
+
+static_assert(TIMER0_CFG.index >= 0, "Timer0: no prescaler reaches TIMER0_PERIOD_US");
+static_assert(TIMER0_CFG.period_ns <= 4 * TIMER0_PERIOD_US * 1000UL, "Timer0: overflow period too coarse");
+static_assert(TIMER1_CFG.index >= 0, "Timer1: TIMER1_HZ out of range");
+static_assert(TIMER1_CFG.error_ppm <= TIMER1_MAX_PPM && TIMER1_CFG.error_ppm >= -TIMER1_MAX_PPM,
+		"Timer1: clock would drift more than TIMER1_MAX_PPM, choose another F_CPU");
+static_assert(TIMER2_CFG.index >= 0, "Timer2: BUZZER_HZ out of range");
+static_assert(TIMER2_CFG.error_ppm <= TIMER2_MAX_PPM && TIMER2_CFG.error_ppm >= -TIMER2_MAX_PPM,
+		"Timer2: buzzer tone too far from BUZZER_HZ");
+
+/** Converts a duration in milliseconds to a number of Timer0 interrupts. */
+#define TIMER0_COUNT(ms)	(static_cast<int>(timer_count((ms), TIMER0_CFG)))
+
+static_assert(timer_count(PERIOD_LONG_PRESS, TIMER0_CFG) <= 32767 && timer_count(PERIOD_BACKLIGHT, TIMER0_CFG) <= 32767,
+		"Timer0: counters overflow, raise TIMER0_PERIOD_US");
+static_assert(timer_count(PERIOD_BUZZER_SHORT, TIMER0_CFG) >= 1, "Timer0: PERIOD_BUZZER_SHORT too short");
+static_assert(timer_count_error(PERIOD_BUZZER_SHORT, TIMER0_CFG) <= 50 && timer_count_error(PERIOD_BUZZER_SHORT, TIMER0_CFG) >= -50,
+		"Timer0: PERIOD_BUZZER_SHORT can't be represented within 5%");
+
+#endif /* TIMERS_H_ */
@@ -0,0 +1,697 @@
+/*
+ * Virtual time simulation of the CodAlarm alarm, snooze and switch handling.
+ *
+ * Runs the firmware application itself (CodAlarm/main.cpp: main loop, interrupt handlers, button
+ * handlers and state machine) on the host build. The program plays the hardware: Timer1 compare
+ * interrupts at the length of second TimeSync asks for, Timer0 overflows while something needs
+ * them (a button held, the backlight or the buzzer counting down), the serial line and the EEPROM
+ * always ready. The main loop runs after each interrupt. Idle stretches cost one Timer1 interrupt
+ * and one main loop pass per second, so days of virtual time take milliseconds.
+ *
+ * A scenario sets the clock to the wall time and an alarm, then a user presses buttons and moves
+ * the switch: at given times, and in reaction to each ring (stop, snooze or switch off, after a
+ * delay). Timer1 runs with a frequency error. Checked all along:
+ * - every alarm time reached with the switch on rings, every snooze rings within 5 minutes:
+ *   otherwise the alarm is missed, with the state at that time as the cause;
+ * - accuracy: wall time of each alarm ring against the alarm time, the drift of the clock;
+ * - anomalies: ringing or snoozed with the switch off, buzzer silent while ringing or stuck on
+ *   after a beep, a ring at neither the alarm nor the snooze time, a clock out of range.
+ *
+ * The scripted scenarios come first, each with the number of missed alarms it expects. Then
+ * random scenarios, one process each (the firmware state is global), on all processors. A single
+ * random scenario prints its events, to replay a failure from its seed.
+ *
+ * Usage: alarmsim [scenarios] [days] [first_seed]		defaults: 1000 scenarios of 2 days, seed 1
+ *        exit status 1 on an anomaly, a crash or a scripted scenario not as expected
+ */
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+
+#include "constants.h"
+#include "core/CodAlarm.h"
+
+#include <avr/io.h>
+
+#define BACKLIGHT_OFF	-1		// main.cpp
+#define BUZZER_OFF		-1
+
+// Application, main.cpp
+extern CodAlarm ca;
+extern int backlight_counter;
+extern int buzzer_counter;
+void setup();
+void loop();
+
+extern "C" void TIMER0_OVF_vect(void);
+extern "C" void TIMER1_COMPA_vect(void);
+extern "C" void EE_READY_vect(void);
+extern "C" void USART_UDRE_vect(void);
+extern "C" void USART_TX_vect(void);
+
+/** Timer0 overflow period, microseconds of the nominal clock. */
+#define T0_US			(256.0 * TIMER0_CFG.div * 1e6 / F_CPU)
+
+/** Button held for a short and a long press, milliseconds. */
+#define PRESS_MS		150
+#define LONG_PRESS_MS	(PERIOD_LONG_PRESS + 500)
+
+/** Longest wait for a snooze to ring, seconds: the snooze time is 5 minutes after the last ring. */
+#define SNOOZE_S		(5 * M_SEC)
+
+#define NEVER			HUGE_VAL
+
+/** What the user does. */
+enum t_act {
+	ACT_NONE,
+	ACT_STOP,
+	ACT_SNOOZE,
+	/** Switch off, then on again after the second delay. */
+	ACT_SWITCH_OFF,
+	ACT_SWITCH_ON,
+	ACT_MODE,
+	ACT_SET_ALARM,
+	ACT_SET_ALARM_LONG,
+	/** Internal: a button released. */
+	ACT_RELEASE
+};
+
+/** Input pin, wired as in constants.h. */
+struct t_input {
+	volatile uint8_t* pin;
+	uint8_t line;
+};
+
+/** Reaction to a ring. */
+struct t_reaction {
+	t_act act;
+	/** Seconds after the ring starts. */
+	double delay;
+	/** Seconds before the switch goes back on, for ACT_SWITCH_OFF. */
+	double off;
+};
+
+/** Action at a given time. */
+struct t_step {
+	/** Seconds since the start. */
+	double time;
+	t_act act;
+	/** Seconds before the switch goes back on, for ACT_SWITCH_OFF. */
+	double off;
+};
+
+/** Action waiting for its time. */
+struct t_pending {
+	t_act act;
+	double off;
+	/** Button to release, ACT_RELEASE. */
+	const t_input* button;
+};
+
+#define N_REACTIONS		4
+#define N_STEPS			16
+
+struct t_scenario {
+	const char* name;
+	/** Timer1 frequency error, ppm. */
+	double ppm;
+	double days;
+	/** Clock at the start, set to the wall time, and alarm, seconds of the day. */
+	long clock;
+	long alarm;
+	/** Reactions to the rings in order, the last one repeated. None: random reactions. */
+	t_reaction reactions[N_REACTIONS];
+	t_step steps[N_STEPS];
+	/** Missed alarms expected, scripted scenarios. */
+	int missed;
+};
+
+/** Results of a scenario. */
+struct t_result {
+	long seed;
+	bool crashed;
+	unsigned alarms, rings, snoozes;
+	/** Missed: alarm time reached in a setting state, with a snooze pending, snooze never rang. */
+	unsigned missed_setting, missed_snoozed, missed_snooze;
+	unsigned anomalies;
+	double max_error, sum_error;
+	unsigned errors;
+	/** First missed alarm or anomaly. */
+	char note[120];
+
+	unsigned missed() const {
+		return missed_setting + missed_snoozed + missed_snooze;
+	}
+};
+
+#define INPUT(name)		{ &PIN(PORT_##name), LINE_##name }
+
+static const t_input SWITCH = INPUT(SWITCH);
+static const t_input BUTTONS[] = {
+	INPUT(BTN_STOP_ALARM), INPUT(BTN_SNOOZE), INPUT(BTN_MODE), INPUT(BTN_SET_ALARM)
+};
+
+static const char* const STATE_NAMES[] = {
+	"IDLE", "SET_CLOCK1", "SET_CLOCK2", "SET_ALARM1", "SET_ALARM2", "RING"
+};
+
+static double uniform(double a, double b) {
+	return a + (b - a) * rand() / RAND_MAX;
+}
+
+/** One run of the application under virtual time. */
+class Sim {
+public:
+	Sim(const t_scenario& _scenario, long seed, bool _verbose) : scenario(_scenario), verbose(_verbose) {
+		memset(&result, 0, sizeof(result));
+		result.seed = seed;
+		speed = 1 + scenario.ppm * 1e-6;
+	}
+
+	t_result run();
+
+private:
+	const t_scenario& scenario;
+	bool verbose;
+	t_result result;
+
+	/** Oscillator speed, 1 + frequency error. */
+	double speed;
+
+	/** Wall time since the start, and next interrupts, microseconds. */
+	double t = 0;
+	double next_t0 = NEVER, next_t1 = 0, t1_period = 0;
+
+	/** Pending actions, by wall time. */
+	std::multimap<double, t_pending> actions;
+
+	/** Buttons held. */
+	int held = 0;
+
+	/** Rings seen, for the scripted reactions. */
+	int reaction = 0;
+
+	/** Wall time a snooze must ring by, NEVER if none pending. */
+	double snooze_due = NEVER;
+
+	/** Since when the buzzer is on or off, or the ring started or ended. */
+	double buzzer_since = 0;
+	bool buzzer_on = false;
+
+	void _tick();
+	void _overflow();
+	void _pass();
+	void _service();
+	void _act(const t_pending&);
+	void _press(const t_input&, double);
+	void _check(t_state);
+	void _react();
+	void _missed(unsigned*, const char*);
+	void _anomaly(const char*, ...);
+	void _log(const char*, ...);
+
+	/** Wall time of day, seconds. */
+	double _wall() {
+		return fmod(scenario.clock + t / 1e6, D_SEC);
+	}
+};
+
+t_result Sim::run() {
+	// Released buttons are high, the switch is on
+	PINB = PINC = PIND = 0xFF;
+
+	setup();
+
+	ca.clock.setValue(scenario.clock);
+	ca.alarm.setValue(scenario.alarm);
+
+	for(const t_step& step : scenario.steps)
+		if(step.act != ACT_NONE)
+			actions.insert({ step.time * 1e6, { step.act, step.off, NULL } });
+
+	t1_period = (host_timer1_top + 1) * (double) TIMER1_CFG.div * 1e6 / F_CPU / speed;
+	next_t1 = t1_period;
+
+	for(double end = scenario.days * D_SEC * 1e6; t < end; ) {
+		// Timer0 overflows are only played when something counts them, in phase with Timer1
+		bool active = held || backlight_counter != BACKLIGHT_OFF || buzzer_counter != BUZZER_OFF;
+		if(!active)
+			next_t0 = NEVER;
+		else if(next_t0 == NEVER)
+			next_t0 = (floor(t / (T0_US / speed)) + 1) * (T0_US / speed);
+
+		double next_action = actions.empty() ? NEVER : actions.begin()->first;
+
+		if(next_action <= next_t1 && next_action <= next_t0) {
+			t = next_action;
+			t_pending action = actions.begin()->second;
+			actions.erase(actions.begin());
+			_act(action);
+			_pass();
+		} else if(next_t1 <= next_t0) {
+			t = next_t1;
+			_tick();
+			if(!active)
+				_pass();
+		} else {
+			t = next_t0;
+			_overflow();
+			_pass();
+		}
+	}
+
+	return result;
+}
+
+void Sim::_tick() {
+	t_state before = ca.state;
+
+	host_timer1_count = 0;
+	TIMER1_COMPA_vect();
+	_service();
+
+	// Length of the next second, as TimeSync set it
+	t1_period = (host_timer1_top + 1) * (double) TIMER1_CFG.div * 1e6 / F_CPU / speed;
+	next_t1 += t1_period;
+
+	long clock = ca.clock.getValue();
+	if(clock < 0 || clock >= D_SEC)
+		_anomaly("clock out of range: %ld", clock);
+
+	// Alarm time with the switch on: must be ringing now
+	if(ca.io.getSwitch() && clock == ca.alarm.getValue()) {
+		result.alarms++;
+
+		if(ca.state != RING) {
+			if(ca.snoozed)
+				_missed(&result.missed_snoozed, "snooze pending");
+			else
+				_missed(&result.missed_setting, STATE_NAMES[before]);
+		}
+	}
+
+	_check(before);
+}
+
+void Sim::_overflow() {
+	t_state before = ca.state;
+
+	TIMER0_OVF_vect();
+	_service();
+	next_t0 += T0_US / speed;
+	_check(before);
+}
+
+void Sim::_pass() {
+	t_state before = ca.state;
+
+	// Position in the second, for the blinking digits
+	double phase = 1 - (next_t1 - t) / t1_period;
+	host_timer1_count = (uint16_t) (fmin(fmax(phase, 0), 1) * host_timer1_top);
+
+	loop();
+	_service();
+
+	if(ca.state == RING && !ca.io.getSwitch())
+		_anomaly("ringing with the switch off");
+	if(ca.snoozed && !ca.io.getSwitch())
+		_anomaly("snooze kept with the switch off");
+
+	// Snooze cancelled: by the switch only
+	if(snooze_due != NEVER && !ca.snoozed && ca.state != RING)
+		snooze_due = NEVER;
+
+	_check(before);
+}
+
+void Sim::_service() {
+	// Serial line and EEPROM ready at once
+	while(UCSR0B & (1 << UDRIE0))
+		USART_UDRE_vect();
+	if(UCSR0B & (1 << TXCIE0))
+		USART_TX_vect();
+	while(EECR & (1 << EERIE))
+		EE_READY_vect();
+}
+
+void Sim::_check(t_state before) {
+	// Ring started
+	if(before != RING && ca.state == RING) {
+		long clock = ca.clock.getValue();
+		result.rings++;
+		_log("ring");
+
+		if(snooze_due != NEVER && t <= snooze_due) {
+			result.snoozes++;
+			snooze_due = NEVER;
+		} else if(clock == ca.alarm.getValue()) {
+			double error = _wall() - ca.alarm.getValue();
+			error -= round(error / D_SEC) * D_SEC;
+
+			result.max_error = fmax(result.max_error, fabs(error));
+			result.sum_error += fabs(error);
+			result.errors++;
+		} else if(!ca.snoozed || clock != ca.snooze.getValue()) {
+			_anomaly("ring at neither the alarm nor the snooze time");
+		}
+
+		_react();
+	}
+
+	if(snooze_due != NEVER && t > snooze_due) {
+		snooze_due = NEVER;
+		_missed(&result.missed_snooze, "snooze time already past");
+	}
+
+	// Buzzer: beeps with 1 s pauses while ringing, short beeps otherwise
+	bool buzzing = TIMSK2 & (1 << OCIE2A);
+	if(buzzing != buzzer_on || (before == RING) != (ca.state == RING)) {
+		buzzer_on = buzzing;
+		buzzer_since = t;
+	}
+
+	double since = (t - buzzer_since) / 1000;
+	if(ca.state == RING && !buzzer_on && since > PERIOD_BUZZER_LONG + 2 * T0_US / 1000) {
+		_anomaly("buzzer silent while ringing");
+		buzzer_since = t;
+	}
+	if(ca.state != RING && buzzer_on && since > PERIOD_BUZZER_LONG + 2 * T0_US / 1000) {
+		_anomaly("buzzer stuck on");
+		buzzer_since = t;
+	}
+}
+
+void Sim::_react() {
+	t_reaction r;
+
+	if(scenario.reactions[0].act != ACT_NONE) {
+		// Scripted, the last one repeated
+		int i = 0;
+		while(i < reaction && i < N_REACTIONS - 1 && scenario.reactions[i + 1].act != ACT_NONE)
+			i++;
+		r = scenario.reactions[i];
+	} else {
+		// Mostly within the snooze time, sometimes much later
+		double p = uniform(0, 1);
+		double delay = uniform(0, 1) < 0.1 ? uniform(SNOOZE_S, 3 * SNOOZE_S) : uniform(2, 240);
+
+		if(p < 0.5)
+			r = { ACT_STOP, delay, 0 };
+		else if(p < 0.85)
+			r = { ACT_SNOOZE, delay, 0 };
+		else
+			r = { ACT_SWITCH_OFF, delay, uniform(60, 3600) };
+	}
+
+	reaction++;
+	actions.insert({ t + r.delay * 1e6, { r.act, r.off, NULL } });
+}
+
+void Sim::_act(const t_pending& action) {
+	static const char* const NAMES[] = {
+		"", "stop", "snooze", "switch off", "switch on", "mode", "set alarm", "set alarm long", "release"
+	};
+	if(action.act != ACT_RELEASE)
+		_log("%s", NAMES[action.act]);
+
+	switch(action.act) {
+	case ACT_STOP:
+		_press(BUTTONS[0], PRESS_MS);
+		break;
+
+	case ACT_SNOOZE:
+		// Snooze pressed while ringing: must ring again within the snooze time
+		if(ca.state == RING)
+			snooze_due = t + (SNOOZE_S + 2) * 1e6;
+		_press(BUTTONS[1], PRESS_MS);
+		break;
+
+	case ACT_SWITCH_OFF:
+		*SWITCH.pin &= ~(1 << SWITCH.line);
+		actions.insert({ t + action.off * 1e6, { ACT_SWITCH_ON, 0, NULL } });
+		break;
+
+	case ACT_SWITCH_ON:
+		*SWITCH.pin |= 1 << SWITCH.line;
+		break;
+
+	case ACT_MODE:
+		_press(BUTTONS[2], PRESS_MS);
+		break;
+
+	case ACT_SET_ALARM:
+		_press(BUTTONS[3], PRESS_MS);
+		break;
+
+	case ACT_SET_ALARM_LONG:
+		_press(BUTTONS[3], LONG_PRESS_MS);
+		break;
+
+	case ACT_RELEASE:
+		*action.button->pin |= 1 << action.button->line;
+		held--;
+		break;
+
+	case ACT_NONE:
+		break;
+	}
+}
+
+void Sim::_press(const t_input& button, double ms) {
+	*button.pin &= ~(1 << button.line);
+	held++;
+	actions.insert({ t + ms * 1000, { ACT_RELEASE, 0, &button } });
+}
+
+void Sim::_missed(unsigned* count, const char* cause) {
+	(*count)++;
+	_log("missed: %s", cause);
+	if(!result.note[0])
+		snprintf(result.note, sizeof(result.note), "day %d %02d:%02d missed: %s", (int) (t / 1e6 / D_SEC),
+				(int) _wall() / H_SEC, (int) _wall() % H_SEC / M_SEC, cause);
+}
+
+void Sim::_anomaly(const char* format, ...) {
+	char text[80];
+	va_list args;
+	va_start(args, format);
+	vsnprintf(text, sizeof(text), format, args);
+	va_end(args);
+
+	result.anomalies++;
+	_log("anomaly: %s", text);
+	if(!result.note[0] || result.anomalies == 1)
+		snprintf(result.note, sizeof(result.note), "day %d %02d:%02d %s", (int) (t / 1e6 / D_SEC),
+				(int) _wall() / H_SEC, (int) _wall() % H_SEC / M_SEC, text);
+}
+
+void Sim::_log(const char* format, ...) {
+	if(!verbose)
+		return;
+
+	long wall = (long) _wall();
+	printf("day %d %02ld:%02ld:%02ld  clock %05ld  %-10s  ", (int) (t / 1e6 / D_SEC), wall / H_SEC,
+			wall % H_SEC / M_SEC, wall % M_SEC, ca.clock.getValue(), STATE_NAMES[ca.state]);
+
+	va_list args;
+	va_start(args, format);
+	vprintf(format, args);
+	va_end(args);
+	printf("\n");
+}
+
+/** Scripted scenarios: alarm at 7:00, clock set a minute before. */
+static const t_scenario SCRIPTED[] = {
+	{ "stop",			0,		1,	6 * H_SEC + 59 * M_SEC,	7 * H_SEC,
+		{ { ACT_STOP, 10, 0 } }, {}, 0 },
+	{ "snooze 3 times",	0,		1,	6 * H_SEC + 59 * M_SEC,	7 * H_SEC,
+		{ { ACT_SNOOZE, 20, 0 }, { ACT_SNOOZE, 20, 0 }, { ACT_SNOOZE, 20, 0 }, { ACT_STOP, 20, 0 } }, {}, 0 },
+	{ "late snooze",	0,		2,	6 * H_SEC + 59 * M_SEC,	7 * H_SEC,
+		{ { ACT_SNOOZE, 7 * M_SEC, 0 }, { ACT_STOP, 10, 0 } }, {}, 2 },
+	{ "switch off",		0,		2,	6 * H_SEC + 59 * M_SEC,	7 * H_SEC,
+		{ { ACT_SWITCH_OFF, 5, 600 } }, {}, 0 },
+	{ "switch off all day", 0,	2,	6 * H_SEC + 59 * M_SEC,	7 * H_SEC,
+		{ { ACT_STOP, 5, 0 } }, { { 2 * H_SEC, ACT_SWITCH_OFF, D_SEC } }, 0 },
+	{ "setting the alarm", 0,	1,	6 * H_SEC + 59 * M_SEC,	7 * H_SEC,
+		{ { ACT_STOP, 5, 0 } },
+		{ { 50, ACT_MODE, 0 }, { 55, ACT_SET_ALARM_LONG, 0 }, { 65, ACT_SET_ALARM, 0 }, { 70, ACT_SET_ALARM, 0 } }, 1 },
+	{ "4 weeks at 50 ppm", 50,	28,	6 * H_SEC + 59 * M_SEC,	7 * H_SEC,
+		{ { ACT_STOP, 30, 0 } }, {}, 0 },
+};
+
+#define N_SCRIPTED		(sizeof(SCRIPTED) / sizeof(SCRIPTED[0]))
+
+/** Random scenario: user, oscillator, times of the day. */
+static t_scenario random_scenario(double days) {
+	t_scenario s;
+	memset(&s, 0, sizeof(s));
+
+	s.name = "random";
+	s.ppm = uniform(-2 * TIMER1_MAX_PPM, 2 * TIMER1_MAX_PPM);
+	s.days = days;
+	s.clock = (long) uniform(0, D_SEC - 1);
+	s.alarm = (long) uniform(0, 24 * 60 - 1) * M_SEC;
+
+	// A few things during the stay: mode changes, a visit to the alarm settings, a night off
+	int n = 0;
+	for(int day = 0; day < days && n <= N_STEPS - 5; day++) {
+		if(uniform(0, 1) < 0.5)
+			s.steps[n++] = { (day + uniform(0, 1)) * D_SEC, ACT_MODE, 0 };
+		if(uniform(0, 1) < 0.2) {
+			double at = (day + uniform(0, 1)) * D_SEC;
+			s.steps[n++] = { at, ACT_SET_ALARM_LONG, 0 };
+			s.steps[n++] = { at + 5, ACT_SET_ALARM, 0 };
+			s.steps[n++] = { at + 6, ACT_SET_ALARM, 0 };
+		}
+		if(n < N_STEPS && uniform(0, 1) < 0.1)
+			s.steps[n++] = { (day + uniform(0, 1)) * D_SEC, ACT_SWITCH_OFF, uniform(600, 6 * H_SEC) };
+	}
+
+	return s;
+}
+
+/** Runs a scenario in its own process, the firmware state being global. */
+static pid_t start(const t_scenario* scripted, double days, long seed, int* fd) {
+	int pipes[2];
+	if(pipe(pipes) != 0)
+		return -1;
+
+	pid_t pid = fork();
+	if(pid == 0) {
+		close(pipes[0]);
+		srand(seed);
+
+		t_scenario scenario = scripted ? *scripted : random_scenario(days);
+		t_result result = Sim(scenario, seed, false).run();
+		ssize_t written = write(pipes[1], &result, sizeof(result));
+		_exit(written == sizeof(result) ? 0 : 1);
+	}
+
+	close(pipes[1]);
+	*fd = pipes[0];
+	return pid;
+}
+
+static t_result finish(pid_t pid, int fd, long seed) {
+	t_result result;
+	int status;
+
+	waitpid(pid, &status, 0);
+	if(read(fd, &result, sizeof(result)) != sizeof(result) || !WIFEXITED(status) || WEXITSTATUS(status)) {
+		memset(&result, 0, sizeof(result));
+		result.seed = seed;
+		result.crashed = true;
+		snprintf(result.note, sizeof(result.note), "crashed");
+	}
+	close(fd);
+	return result;
+}
+
+int main(int argc, char** argv) {
+	long scenarios = argc > 1 ? atol(argv[1]) : 1000;
+	double days = argc > 2 ? atof(argv[2]) : 2;
+	long first = argc > 3 ? atol(argv[3]) : 1;
+	bool ok = true;
+
+	// One scenario: replay it with its events
+	if(scenarios == 1) {
+		srand(first);
+		t_scenario scenario = random_scenario(days);
+		printf("seed %ld: %.0f ppm, clock %05ld, alarm %05ld\n", first, scenario.ppm, scenario.clock, scenario.alarm);
+		t_result r = Sim(scenario, first, true).run();
+		printf("%u alarms, %u rings, %u missed, %u anomalies\n", r.alarms, r.rings, r.missed(), r.anomalies);
+		return r.anomalies ? 1 : 0;
+	}
+
+	printf("scenario             days  rings  snoozes  missed  expected  max_error_s  anomalies\n");
+	for(const t_scenario& s : SCRIPTED) {
+		int fd;
+		pid_t pid = start(&s, 0, 1, &fd);
+		t_result r = finish(pid, fd, 1);
+
+		bool pass = !r.crashed && !r.anomalies && (int) r.missed() == s.missed;
+		ok = ok && pass;
+		printf("%-20s %-5.0f %-6u %-8u %-7u %-9d %-12.1f %-3u %s%s%s\n", s.name, s.days, r.rings, r.snoozes,
+				r.missed(), s.missed, r.max_error, r.anomalies, pass ? "ok" : "FAIL", r.note[0] ? "  " : "", r.note);
+	}
+
+	// Random scenarios, as many at once as processors
+	long jobs = sysconf(_SC_NPROCESSORS_ONLN);
+	if(jobs < 1)
+		jobs = 1;
+
+	auto begin = std::chrono::steady_clock::now();
+	std::map<pid_t, std::pair<long, int>> running;
+	t_result total;
+	memset(&total, 0, sizeof(total));
+	long failed = 0, crashed = 0;
+
+	for(long seed = first, done = 0; done < scenarios; ) {
+		if(seed < first + scenarios && (long) running.size() < jobs) {
+			int fd;
+			pid_t pid = start(NULL, days, seed, &fd);
+			if(pid > 0) {
+				running[pid] = { seed++, fd };
+				continue;
+			}
+		}
+
+		// Collect the first to finish
+		int status;
+		pid_t pid = waitpid(-1, &status, 0);
+		auto job = running.find(pid);
+		if(job == running.end())
+			continue;
+
+		t_result r;
+		if(read(job->second.second, &r, sizeof(r)) != sizeof(r) || !WIFEXITED(status) || WEXITSTATUS(status)) {
+			memset(&r, 0, sizeof(r));
+			r.seed = job->second.first;
+			r.crashed = true;
+			snprintf(r.note, sizeof(r.note), "crashed");
+		}
+		close(job->second.second);
+		running.erase(job);
+		done++;
+
+		total.alarms += r.alarms;
+		total.rings += r.rings;
+		total.snoozes += r.snoozes;
+		total.missed_setting += r.missed_setting;
+		total.missed_snoozed += r.missed_snoozed;
+		total.missed_snooze += r.missed_snooze;
+		total.anomalies += r.anomalies;
+		total.max_error = fmax(total.max_error, r.max_error);
+		total.sum_error += r.sum_error;
+		total.errors += r.errors;
+		crashed += r.crashed;
+
+		if(r.crashed || r.anomalies) {
+			ok = false;
+			if(failed++ < 10)
+				printf("seed %-6ld %s\n", r.seed, r.note);
+		}
+	}
+
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+	printf("%ld random scenarios of %.0f days in %.1f s (%.0f per minute)\n", scenarios, days, seconds,
+			scenarios / seconds * 60);
+	printf("alarms %u, rings %u (snoozes %u), missed %u: %u while setting, %u with a snooze pending, "
+			"%u snoozes past\n", total.alarms, total.rings, total.snoozes,
+			total.missed_setting + total.missed_snoozed + total.missed_snooze, total.missed_setting,
+			total.missed_snoozed, total.missed_snooze);
+	printf("alarm error: mean %.1f s, max %.1f s\n", total.errors ? total.sum_error / total.errors : 0,
+			total.max_error);
+	printf("anomalies %u in %ld scenarios, crashes %ld %s\n", total.anomalies, failed, crashed, ok ? "ok" : "FAIL");
+
+	return ok ? 0 : 1;
+}
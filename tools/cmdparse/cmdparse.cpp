@@ -0,0 +1,171 @@
+/*
+ * Runs the CodAlarm console parser (CodAlarm/core/Command.cpp) on the host.
+ *
+ * Without arguments, parses the lines of the table below and compares each result with the
+ * expected command: id, set, hours, minutes and seconds. For lines the parser rejects (empty,
+ * unknown, invalid) only the id and set are compared, the other fields being left as parsed so far.
+ * Each new command or value adds its lines to the table, valid and invalid.
+ *
+ * With "-", reads command lines from stdin instead and prints how the firmware would parse them,
+ * one line each:
+ *
+ *     <id> <set> <hours> <minutes> <seconds>
+ *
+ * Useful to check the grammar of new commands without flashing the board.
+ *
+ * Build: g++ -std=c++11 -I ../../CodAlarm/core -I ../../CodAlarm/hal/host -o cmdparse cmdparse.cpp ../../CodAlarm/core/Command.cpp
+ * Usage: cmdparse                    exit status 1 if a line of the table is parsed differently
+ *        printf 'time 07:30\nmode 13\n' | cmdparse -
+ */
+
+#include <cstdio>
+#include <cstring>
+
+#include "Command.h"
+
+static const char* names[] = {
+	"empty", "unknown", "invalid", "help", "time", "alarm", "mode", "state", "stats", "log",
+	"telemetry", "sync", "bus", "prof", "mem"
+};
+
+/** Line of the table and the command expected. */
+struct t_case {
+	const char* line;
+	t_command expected;
+};
+
+static const t_case CASES[] = {
+	// Empty lines and keywords
+	{ "",                          { CMD_EMPTY,     false, 0, 0, 0 } },
+	{ "   ",                       { CMD_EMPTY,     false, 0, 0, 0 } },
+	{ "help",                      { CMD_HELP,      false, 0, 0, 0 } },
+	{ "  help  ",                  { CMD_HELP,      false, 0, 0, 0 } },
+	{ "state",                     { CMD_STATE,     false, 0, 0, 0 } },
+	{ "stats",                     { CMD_STATS,     false, 0, 0, 0 } },
+	{ "log",                       { CMD_LOG,       false, 0, 0, 0 } },
+	{ "prof",                      { CMD_PROF,      false, 0, 0, 0 } },
+	{ "mem",                       { CMD_MEM,       false, 0, 0, 0 } },
+	{ "hello",                     { CMD_UNKNOWN,   false, 0, 0, 0 } },
+	{ "Help",                      { CMD_UNKNOWN,   false, 0, 0, 0 } },
+	{ "he",                        { CMD_UNKNOWN,   false, 0, 0, 0 } },
+	{ "helpme",                    { CMD_UNKNOWN,   false, 0, 0, 0 } },
+	{ "help now",                  { CMD_INVALID,   true,  0, 0, 0 } },
+	{ "mem 1",                     { CMD_INVALID,   true,  0, 0, 0 } },
+
+	// Time, with or without seconds
+	{ "time",                      { CMD_TIME,      false, 0, 0, 0 } },
+	{ "time 07:30",                { CMD_TIME,      true,  7, 30, 0 } },
+	{ "time 7:05",                 { CMD_TIME,      true,  7, 5, 0 } },
+	{ "time 23:59:59",             { CMD_TIME,      true,  23, 59, 59 } },
+	{ "time 00:00:00",             { CMD_TIME,      true,  0, 0, 0 } },
+	{ " time  12:34  ",            { CMD_TIME,      true,  12, 34, 0 } },
+	{ "time 24:00",                { CMD_INVALID,   true,  0, 0, 0 } },
+	{ "time 12:60",                { CMD_INVALID,   true,  0, 0, 0 } },
+	{ "time 12:30:60",             { CMD_INVALID,   true,  0, 0, 0 } },
+	{ "time 123:00",               { CMD_INVALID,   true,  0, 0, 0 } },
+	{ "time 12:3a",                { CMD_INVALID,   true,  0, 0, 0 } },
+	{ "time 12:",                  { CMD_INVALID,   true,  0, 0, 0 } },
+	{ "time :30",                  { CMD_INVALID,   true,  0, 0, 0 } },
+	{ "time 1230",                 { CMD_INVALID,   true,  0, 0, 0 } },
+	{ "time 12:30:",               { CMD_INVALID,   true,  0, 0, 0 } },
+	{ "time 12:30 now",            { CMD_INVALID,   true,  0, 0, 0 } },
+
+	// Alarm, no seconds
+	{ "alarm",                     { CMD_ALARM,     false, 0, 0, 0 } },
+	{ "alarm 06:45",               { CMD_ALARM,     true,  6, 45, 0 } },
+	{ "alarm 06:45:10",            { CMD_INVALID,   true,  0, 0, 0 } },
+	{ "alarm 25:00",               { CMD_INVALID,   true,  0, 0, 0 } },
+
+	// Mode
+	{ "mode",                      { CMD_MODE,      false, 0, 0, 0 } },
+	{ "mode 12",                   { CMD_MODE,      true,  12, 0, 0 } },
+	{ "mode 24",                   { CMD_MODE,      true,  24, 0, 0 } },
+	{ "mode 13",                   { CMD_INVALID,   true,  0, 0, 0 } },
+	{ "mode 0",                    { CMD_INVALID,   true,  0, 0, 0 } },
+	{ "mode 120",                  { CMD_INVALID,   true,  0, 0, 0 } },
+	{ "mode h12",                  { CMD_INVALID,   true,  0, 0, 0 } },
+
+	// On and off
+	{ "telemetry",                 { CMD_TELEMETRY, false, 0, 0, 0 } },
+	{ "telemetry on",              { CMD_TELEMETRY, true,  1, 0, 0 } },
+	{ "telemetry off",             { CMD_TELEMETRY, true,  0, 0, 0 } },
+	{ "telemetry yes",             { CMD_INVALID,   true,  0, 0, 0 } },
+	{ "telemetry ON",              { CMD_INVALID,   true,  0, 0, 0 } },
+	{ "sync",                      { CMD_SYNC,      false, 0, 0, 0 } },
+	{ "sync on",                   { CMD_SYNC,      true,  1, 0, 0 } },
+	{ "sync off",                  { CMD_SYNC,      true,  0, 0, 0 } },
+	{ "sync 1",                    { CMD_INVALID,   true,  0, 0, 0 } },
+
+	// Bus role
+	{ "bus",                       { CMD_BUS,       false, 0, 0, 0 } },
+	{ "bus off",                   { CMD_BUS,       true,  0, 0, 0 } },
+	{ "bus master",                { CMD_BUS,       true,  1, 0, 0 } },
+	{ "bus slave",                 { CMD_BUS,       true,  2, 0, 0 } },
+	{ "bus primary",               { CMD_INVALID,   true,  0, 0, 0 } },
+
+	// Overlong keyword and value, up to CONSOLE_LINE bytes as the console passes them
+	{ "telemetryy on",             { CMD_UNKNOWN,   false, 0, 0, 0 } },
+	{ "abcdefghijklmnopqrstuvwx",  { CMD_UNKNOWN,   false, 0, 0, 0 } },
+	{ "time 00000000000012:30",    { CMD_INVALID,   true,  0, 0, 0 } },
+	{ "bus masterslavemaster",     { CMD_INVALID,   true,  0, 0, 0 } },
+	{ "time 12:30:00:00",          { CMD_INVALID,   true,  0, 0, 0 } },
+};
+
+#define N_CASES	(sizeof(CASES) / sizeof(CASES[0]))
+
+static void print(const t_command& cmd) {
+	printf("%s %d %02u %02u %02u", names[cmd.id], cmd.set, cmd.hours, cmd.minutes, cmd.seconds);
+}
+
+/**
+ * Parses the lines of the table, prints those parsed differently.
+ * \return number of differences
+ */
+static unsigned check() {
+	unsigned failed = 0;
+
+	for(unsigned i = 0; i < N_CASES; i++) {
+		const t_command& e = CASES[i].expected;
+		t_command cmd;
+
+		t_command_id id = command_parse(CASES[i].line, &cmd);
+		bool same = id == e.id && cmd.id == e.id && cmd.set == e.set;
+		if(e.id != CMD_EMPTY && e.id != CMD_UNKNOWN && e.id != CMD_INVALID)
+			same = same && cmd.hours == e.hours && cmd.minutes == e.minutes && cmd.seconds == e.seconds;
+
+		if(!same) {
+			printf("\"%s\": ", CASES[i].line);
+			print(cmd);
+			printf(", expected ");
+			print(e);
+			printf("\n");
+			failed++;
+		}
+	}
+
+	printf("%u lines, %u differ\n", (unsigned) N_CASES, failed);
+	return failed;
+}
+
+int main(int argc, char** argv) {
+	if(argc < 2)
+		return check() ? 1 : 0;
+
+	if(strcmp(argv[1], "-") != 0) {
+		fprintf(stderr, "usage: %s [-]\n", argv[0]);
+		return 2;
+	}
+
+	char line[256];
+	t_command cmd;
+
+	while(fgets(line, sizeof(line), stdin)) {
+		line[strcspn(line, "\r\n")] = '\0';
+
+		command_parse(line, &cmd);
+		print(cmd);
+		printf("\n");
+	}
+
+	return 0;
+}
@@ -0,0 +1,175 @@
+/*
+ * Model of the page oriented display controllers CodAlarm can drive (CodAlarm/hw/DisplayControllers.h):
+ * ST7565 and SSD1306, fed with the bytes sent on the SPI bus and the state of the A0 line: low for
+ * a command, high for data.
+ *
+ * Display RAM is 8 pages of 8 rows; a data byte is a column of 8 pixels, top row in the least
+ * significant bit, and the column address moves right. Both controllers take the page and column
+ * address commands of the ST7565 (0xB0 | page, 0x10 | high nibble, low nibble). The SSD1306 also has
+ * a horizontal addressing mode (0x20 0x00): data fill a window set with 0x21 and 0x22, moving to the
+ * next page at its right edge. Column 0 is the left edge and page 0 the top: the orientation
+ * commands the drivers send are assumed to give that, and not modelled.
+ *
+ * Besides the image, the model counts commands (argument bytes included), data bytes and redundant
+ * writes (a data byte equal to what RAM already holds), and errors: data before the display is on,
+ * addresses out of range.
+ */
+
+#ifndef PAGEMODEL_H_
+#define PAGEMODEL_H_
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+class PageModel {
+public:
+	static const int WIDTH = 128;
+	static const int HEIGHT = 64;
+
+	/** Controller modelled. */
+	enum t_type { ST7565, SSD1306 };
+
+	/** Bytes received since the last resetCounts(). */
+	struct t_counts {
+		unsigned commands;
+		unsigned data;
+		unsigned redundant;
+		unsigned errors;
+	};
+
+	explicit PageModel(t_type type) : type(type) {
+		memset(ram, 0, sizeof(ram));
+		resetCounts();
+	}
+
+	/**
+	 * Receives a byte.
+	 * \param c byte
+	 * \param a0 state of the A0 line: false for a command
+	 */
+	void receive(uint8_t c, bool a0) {
+		if(!a0)
+			_command(c);
+		else
+			_data(c);
+	}
+
+	/** True if the pixel is on: set in RAM and the display on. */
+	bool pixel(int x, int y) const {
+		return on && (ram[y / 8][x] & (1 << (y % 8)));
+	}
+
+	/** Number of pixels on. */
+	unsigned lit() const {
+		unsigned n = 0;
+		for(int y = 0; y < HEIGHT; y++)
+			for(int x = 0; x < WIDTH; x++)
+				n += pixel(x, y);
+		return n;
+	}
+
+	t_counts counts;
+
+	void resetCounts() {
+		memset(&counts, 0, sizeof(counts));
+	}
+
+private:
+	t_type type;
+
+	/** Display RAM, 132 columns on the ST7565. */
+	uint8_t ram[8][132];
+
+	bool on = false;
+
+	/** Address, and the window of the SSD1306 horizontal mode. */
+	uint8_t page = 0, column = 0;
+	uint8_t column_start = 0, column_end = 127, page_start = 0, page_end = 7;
+	bool horizontal = false;
+
+	/** Command waiting for arguments, how many it takes and how many were received. */
+	uint8_t pending = 0, args = 0, received = 0, arg[2];
+
+	/** Arguments of a command. */
+	uint8_t _args(uint8_t c) const {
+		if(type == ST7565)
+			return c == 0x81 || c == 0xF8 ? 1 : 0;
+
+		switch(c) {
+		case 0x21: case 0x22:
+			return 2;
+		case 0x20: case 0x81: case 0x8D: case 0xA8: case 0xD3: case 0xD5: case 0xD9: case 0xDA: case 0xDB:
+			return 1;
+		default:
+			return 0;
+		}
+	}
+
+	void _command(uint8_t c) {
+		counts.commands++;
+
+		if(received < args) {
+			arg[received++] = c;
+			if(received == args)
+				_execute(pending);
+			return;
+		}
+
+		pending = c;
+		args = _args(c);
+		received = 0;
+		if(!args)
+			_execute(c);
+	}
+
+	void _execute(uint8_t c) {
+		if(c == 0xAF)
+			on = true;
+		else if(c == 0xAE)
+			on = false;
+		else if((c & 0xF0) == 0xB0)
+			page = c & 0x0F;
+		else if((c & 0xF0) == 0x10)
+			column = (column & 0x0F) | (c & 0x0F) << 4;
+		else if((c & 0xF0) == 0x00)
+			column = (column & 0xF0) | (c & 0x0F);
+		else if(type == SSD1306 && c == 0x20)
+			horizontal = arg[0] == 0x00;
+		else if(type == SSD1306 && c == 0x21) {
+			column_start = column = arg[0] & 0x7F;
+			column_end = arg[1] & 0x7F;
+		} else if(type == SSD1306 && c == 0x22) {
+			page_start = page = arg[0] & 0x07;
+			page_end = arg[1] & 0x07;
+		}
+		// Power, bias, contrast, orientation and timing don't touch RAM
+	}
+
+	void _data(uint8_t c) {
+		counts.data++;
+
+		int columns = type == ST7565 ? 132 : 128;
+		if(!on || page >= 8 || column >= columns) {
+			counts.errors++;
+			return;
+		}
+
+		uint8_t* cell = &ram[page][column];
+		if(*cell == c)
+			counts.redundant++;
+		*cell = c;
+
+		if(type == SSD1306 && horizontal) {
+			// Next column of the window, then next page
+			if(column++ == column_end) {
+				column = column_start;
+				page = page == page_end ? page_start : page + 1;
+			}
+		} else if(column < columns - 1) {
+			column++;
+		}
+	}
+};
+
+#endif /* PAGEMODEL_H_ */
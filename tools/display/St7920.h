@@ -0,0 +1,150 @@
+/*
+ * Model of the ST7920 display controller as CodAlarm drives it (CodAlarm/hw/Display.cpp), fed with
+ * the bytes sent on the SPI bus and the state of the A0 line: high for a command, low for data.
+ *
+ * Graphic memory (GDRAM) is 32 rows of 16 words of 16 pixels, most significant bit on the left.
+ * The panel shows rows 0-31 from words 0-7 in its top half, and rows 0-31 from words 8-15 in its
+ * bottom half. In the extended instruction set two address commands set the row, then the word;
+ * data bytes then fill the word, high byte first, and the word address moves right.
+ *
+ * Besides the image, the model counts commands, data bytes and redundant writes (a data byte equal
+ * to what GDRAM already holds), and errors: data outside graphic mode, addresses out of range.
+ */
+
+#ifndef ST7920_H_
+#define ST7920_H_
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+class St7920 {
+public:
+	static const int WIDTH = 128;
+	static const int HEIGHT = 64;
+
+	/** Bytes received since the last resetCounts(). */
+	struct t_counts {
+		unsigned commands;
+		unsigned data;
+		unsigned redundant;
+		unsigned errors;
+	};
+
+	St7920() {
+		memset(gdram, 0, sizeof(gdram));
+		resetCounts();
+	}
+
+	/**
+	 * Receives a byte.
+	 * \param c byte
+	 * \param a0 state of the A0 line: true for a command
+	 */
+	void receive(uint8_t c, bool a0) {
+		if(a0)
+			_command(c);
+		else
+			_data(c);
+	}
+
+	/** True if the pixel is on: set in GDRAM and the graphic display on. */
+	bool pixel(int x, int y) const {
+		int row = y % 32;
+		int word = x / 16 + (y >= 32 ? 8 : 0);
+		return graphic && (gdram[row][word * 2 + (x % 16) / 8] & (0x80 >> (x % 8)));
+	}
+
+	/** Number of pixels on. */
+	unsigned lit() const {
+		unsigned n = 0;
+		for(int y = 0; y < HEIGHT; y++)
+			for(int x = 0; x < WIDTH; x++)
+				n += pixel(x, y);
+		return n;
+	}
+
+	/**
+	 * Writes the panel image, binary PBM (P4): 1 is black, a pixel on.
+	 * \return false on write errors
+	 */
+	bool writePbm(FILE* f) const {
+		uint8_t row[WIDTH / 8];
+
+		fprintf(f, "P4\n%d %d\n", WIDTH, HEIGHT);
+		for(int y = 0; y < HEIGHT; y++) {
+			memset(row, 0, sizeof(row));
+			for(int x = 0; x < WIDTH; x++)
+				if(pixel(x, y))
+					row[x / 8] |= 0x80 >> (x % 8);
+			if(fwrite(row, 1, sizeof(row), f) != sizeof(row))
+				return false;
+		}
+		return true;
+	}
+
+	t_counts counts;
+
+	void resetCounts() {
+		memset(&counts, 0, sizeof(counts));
+	}
+
+private:
+	uint8_t gdram[32][32];
+
+	/** Extended instruction set (RE) and graphic display on (G). */
+	bool extended = false;
+	bool graphic = false;
+
+	/** GDRAM address: row, word and byte in the word. Next address command sets the word. */
+	uint8_t row = 0, word = 0, half = 0;
+	bool set_word = false;
+
+	void _command(uint8_t c) {
+		counts.commands++;
+
+		if((c & 0xE0) == 0x20) {
+			// Function set: RE, and G in the extended set
+			extended = c & 0x04;
+			if(extended)
+				graphic = c & 0x02;
+			set_word = false;
+		} else if(extended && (c & 0x80)) {
+			// GDRAM address, row then word
+			if(!set_word) {
+				row = c & 0x7F;
+				if(row >= 32)
+					counts.errors++;
+			} else {
+				word = c & 0x7F;
+				half = 0;
+				if(word >= 16)
+					counts.errors++;
+			}
+			set_word = !set_word;
+		}
+		// Other basic instructions (clear, display control, entry mode) don't touch GDRAM
+	}
+
+	void _data(uint8_t c) {
+		counts.data++;
+		set_word = false;
+
+		if(!extended || row >= 32 || word >= 16) {
+			counts.errors++;
+			return;
+		}
+
+		uint8_t* cell = &gdram[row][word * 2 + half];
+		if(*cell == c)
+			counts.redundant++;
+		*cell = c;
+
+		// Next byte of the word, then next word
+		half ^= 1;
+		if(!half)
+			word = (word + 1) & 0x0F;
+	}
+};
+
+#endif /* ST7920_H_ */
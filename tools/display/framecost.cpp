@@ -0,0 +1,276 @@
+/*
+ * Frame cost of each display controller policy (CodAlarm/hw/DisplayControllers.h) and link.
+ *
+ * The firmware GUI draws two screens on the host build, the clock at 10:42 and a minute later,
+ * caught on the ST7920 model (St7920.h) as reference images. Each driver, DisplayDriver over a
+ * controller policy and a link, then sends the first screen whole and the second as an incremental
+ * update, the area of the pixels that changed, to a model of its controller (St7920.h,
+ * PageModel.h). The image each model shows must be the reference.
+ *
+ * The USART link (hw/DisplayUsart.h) runs with its interrupts played by this program: USART_UDRE
+ * while enabled, and USART_TX, the bytes loaded having left, when the link waits to change A0.
+ *
+ * For each frame: commands and data bytes on the bus, the busy waits of the driver (host_delay_us),
+ * and the time at F_CPU, estimated from cycle counts below:
+ * - SPI: each byte is 8 bits at the SPI clock of hal_spi_init() plus the loop around the SPIF
+ *   poll, then the busy waits and the 8x8 transposes (display_transpose8()) of the page
+ *   controllers, one after the other;
+ * - USART: the wire, a byte every 16 * (DISPLAY_USART_UBRR + 1) cycles, runs beside the CPU,
+ *   which queues the bytes, runs one interrupt per byte and the transposes: the frame takes the
+ *   longer of both.
+ * - bands (DisplayUsartPipeline): as USART, but the data bytes are not queued one by one: the
+ *   CPU transposes the blocks straight into a band slot while the interrupts send the other one.
+ * The cycle counts are read from the instructions, not measured; see tools/sim/bench for cycle
+ * counts of a firmware build. The latency of each frame is given at 1 MHz and 8 MHz: the cycles
+ * scale with the clock, the SPI and USART clocks too, the busy waits don't. Last, the latency of
+ * each link against the SPI one, for the full frame.
+ *
+ * Usage: framecost
+ *        exit status 1 if an image differs from the reference or a controller saw errors
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <type_traits>
+
+#include "constants.h"
+#include "core/CodAlarm.h"
+#include "core/GUI.h"
+
+#include <avr/io.h>
+
+#include "PageModel.h"
+#include "St7920.h"
+
+/** CPU cycles per bit of the SPI clock, fclk/16 in hal_spi_init(). */
+#define SPI_DIVIDER			16
+
+/** AVR cycles around each SPI byte: store, SPIF poll exit, call and loop. */
+#define SPI_BYTE_CYCLES		8
+
+/** AVR cycles of display_transpose8(), per 8x8 block: 8 ldd, 64 lsl/ror pairs, 8 stores and the pointer. */
+#define TRANSPOSE_CYCLES	164
+
+/** AVR cycles of DisplayUsart::write(), queueing a byte. */
+#define USART_WRITE_CYCLES	35
+
+/** AVR cycles of a USART interrupt of the link: response, vector, saved registers, body and reti. */
+#define USART_ISR_CYCLES	70
+
+/** Extra AVR cycles of the interrupt for a byte of a band: slot, position and length. */
+#define BAND_ISR_CYCLES		12
+
+/** AVR cycles per band: band(), queueBand() and the loop of DisplayPageWriter. */
+#define BAND_CYCLES			60
+
+/** Clocks the latency is given at. */
+static const double clocks[] = { 1e6, 8e6 };
+
+/** Panel image. */
+struct t_image {
+	bool pixel[St7920::HEIGHT][St7920::WIDTH];
+};
+
+/** Controller model the bus is connected to. */
+static void (*model)(uint8_t, bool);
+
+static void spi(uint8_t c) {
+	model(c, PORT(PORT_DISPLAY_A0) & (1 << LINE_DISPLAY_A0));
+}
+
+static St7920 st7920;
+static PageModel st7565(PageModel::ST7565);
+static PageModel ssd1306(PageModel::SSD1306);
+
+static void toSt7920(uint8_t c, bool a0) { st7920.receive(c, a0); }
+static void toSt7565(uint8_t c, bool a0) { st7565.receive(c, a0); }
+static void toSsd1306(uint8_t c, bool a0) { ssd1306.receive(c, a0); }
+
+/** Latency of the full frame of the page controllers, ST7565 and SSD1306, per link (SPI, USART, bands) and clock, in us. */
+static double latency[2][3][2];
+
+/** USART interrupts played. */
+static unsigned interrupts;
+
+/** Plays the USART interrupts of the display link until none is enabled. */
+static void usart() {
+	while(UCSR0B & ((1 << UDRIE0) | (1 << TXCIE0))) {
+		interrupts++;
+		if(UCSR0B & (1 << TXCIE0)) {
+			host_usart_spi_sent = true;
+			DisplayUsart::sent();
+		} else {
+			DisplayUsart::transmit();
+		}
+	}
+	host_usart_spi_sent = true;
+}
+
+template<class Model>
+static void snapshot(const Model& m, t_image* image) {
+	for(int y = 0; y < St7920::HEIGHT; y++)
+		for(int x = 0; x < St7920::WIDTH; x++)
+			image->pixel[y][x] = m.pixel(x, y);
+}
+
+/**
+ * Sends both screens with a driver, prints the cost of each frame.
+ * \return true if the images are right and the controller saw no errors
+ */
+template<class Controller, class Link, class Model>
+static bool measure(const char* name, Model& m, void (*to)(uint8_t, bool), bool pages,
+		const t_image& first, const t_image& second) {
+	DisplayDriver<Controller, Link> display;
+	bool in_bands = std::is_same<Link, DisplayUsartPipeline>::value;
+	bool over_usart = in_bands || std::is_same<Link, DisplayUsart>::value;
+	int link = in_bands ? 2 : over_usart ? 1 : 0;
+	bool ok = true;
+
+	model = to;
+	UCSR0B = 0;
+	display.init();
+	Link::flush();
+
+	const t_image* images[] = { &first, &second };
+	const char* frames[] = { "full", "minute" };
+	for(int f = 0; f < 2; f++) {
+		const t_image& image = *images[f];
+		int x0 = 0, y0 = 0, x1 = St7920::WIDTH - 1, y1 = St7920::HEIGHT - 1;
+
+		if(f == 0) {
+			// Buffer empty and all invalid since init
+			for(int y = 0; y < St7920::HEIGHT; y++)
+				for(int x = 0; x < St7920::WIDTH; x++)
+					display.setPixel(x, y, image.pixel[y][x]);
+		} else {
+			// Only the area of the pixels that changed, as the GUI does
+			x0 = St7920::WIDTH; y0 = St7920::HEIGHT; x1 = -1; y1 = -1;
+			for(int y = 0; y < St7920::HEIGHT; y++)
+				for(int x = 0; x < St7920::WIDTH; x++)
+					if(image.pixel[y][x] != first.pixel[y][x]) {
+						if(x < x0) x0 = x;
+						if(y < y0) y0 = y;
+						if(x > x1) x1 = x;
+						if(y > y1) y1 = y;
+					}
+			display.clear(x0, y0, x1 - x0 + 1, y1 - y0 + 1);
+			for(int y = y0; y <= y1; y++)
+				for(int x = x0; x <= x1; x++)
+					display.setPixel(x, y, image.pixel[y][x]);
+		}
+
+		m.resetCounts();
+		host_delay_us = 0;
+		interrupts = 0;
+		display.update();
+		Link::flush();
+
+		t_image shown;
+		snapshot(m, &shown);
+		bool same = true;
+		for(int y = 0; y < St7920::HEIGHT; y++)
+			for(int x = 0; x < St7920::WIDTH; x++)
+				same = same && shown.pixel[y][x] == image.pixel[y][x];
+		ok = ok && same && !m.counts.errors;
+
+		// Cycles
+		unsigned bus = m.counts.commands + m.counts.data;
+		double transpose = pages ? m.counts.data / 8 * (double) TRANSPOSE_CYCLES : 0;
+		double wire, total;
+		if(in_bands) {
+			// Bands of each page: blocks x0 / 8 to x1 / 8, DISPLAY_BAND / 8 at most
+			unsigned blocks = x1 / 8 - x0 / 8 + 1;
+			unsigned bands = (y1 / 8 - y0 / 8 + 1) * ((blocks + DISPLAY_BAND / 8 - 1) / (DISPLAY_BAND / 8));
+			wire = bus * 16.0 * (DISPLAY_USART_UBRR + 1);
+			double cpu = m.counts.commands * (double) USART_WRITE_CYCLES + bands * (double) BAND_CYCLES
+					+ interrupts * (double) USART_ISR_CYCLES + m.counts.data * (double) BAND_ISR_CYCLES + transpose;
+			total = std::max(wire, cpu);
+		} else if(over_usart) {
+			wire = bus * 16.0 * (DISPLAY_USART_UBRR + 1);
+			double cpu = bus * (double) USART_WRITE_CYCLES + interrupts * (double) USART_ISR_CYCLES + transpose;
+			total = std::max(wire, cpu);
+		} else {
+			wire = bus * 8.0 * SPI_DIVIDER;
+			total = wire + bus * (double) SPI_BYTE_CYCLES + transpose;
+		}
+
+		double us = 1e6 / F_CPU;
+		double total_us = total * us + host_delay_us;
+		double at[2];
+		for(int c = 0; c < 2; c++)
+			at[c] = total * 1e6 / clocks[c] + host_delay_us;
+		if(f == 0 && pages) {
+			int driver = std::is_same<Controller, ControllerSt7565>::value ? 0 : 1;
+			latency[driver][link][0] = at[0];
+			latency[driver][link][1] = at[1];
+		}
+		const char* links[] = { "spi", "usart", "bands" };
+		printf("%-8s %-6s %-7s %-9u %-5u %-6u %-8.0f %-8.0f %-8.0f %-9.0f %-7.0f %-8.0f %-8.0f %s\n", name,
+				links[link], frames[f], m.counts.commands, m.counts.data, interrupts,
+				host_delay_us, wire * us, transpose * us, total_us, bus / total_us * 1e6, at[0], at[1],
+				same ? "ok" : "DIFFERS");
+		if(m.counts.errors)
+			printf("%-8s %-7s %u errors\n", name, frames[f], m.counts.errors);
+	}
+
+	return ok;
+}
+
+int main() {
+	CodAlarm ca;
+	GUI gui(&ca);
+	t_image first, second;
+
+	// Reference images: the GUI on the ST7920 model
+	PORT(PORT_DISPLAY_A0) = 0;
+	model = toSt7920;
+	host_spi_hook = spi;
+	host_idle_hook = usart;
+	ca.display.init();
+
+	ca.state = IDLE;
+	ca.mode = H24;
+	PIN(PORT_SWITCH) = 1 << LINE_SWITCH;
+	host_timer1_count = TIMER1_CMP;
+	ca.alarm.setValue(7 * H_SEC + 30 * M_SEC);
+
+	ca.clock.setValue(10 * H_SEC + 42 * M_SEC);
+	gui.draw();
+	snapshot(st7920, &first);
+
+	ca.clock.setValue(10 * H_SEC + 43 * M_SEC);
+	gui.draw();
+	snapshot(st7920, &second);
+
+	printf("F_CPU %lu Hz, SPI fclk/%d: %.0f us per byte, USART UBRR %d: %.0f us per byte\n\n",
+			(unsigned long) F_CPU, SPI_DIVIDER, 8.0 * SPI_DIVIDER * 1e6 / F_CPU, DISPLAY_USART_UBRR,
+			16.0 * (DISPLAY_USART_UBRR + 1) * 1e6 / F_CPU);
+	printf("driver   link   frame   commands  data  irqs   wait_us  bus_us   xpose_us total_us  bytes/s us_1MHz  us_8MHz  image\n");
+
+	bool ok = true;
+	ok = measure<ControllerSt7920, DisplaySpi>("st7920", st7920, toSt7920, false, first, second) && ok;
+	ok = measure<ControllerSt7565, DisplaySpi>("st7565", st7565, toSt7565, true, first, second) && ok;
+	ok = measure<ControllerSsd1306, DisplaySpi>("ssd1306", ssd1306, toSsd1306, true, first, second) && ok;
+
+	// The USART link starts from a fresh controller
+	st7565 = PageModel(PageModel::ST7565);
+	ssd1306 = PageModel(PageModel::SSD1306);
+	ok = measure<ControllerSt7565, DisplayUsart>("st7565", st7565, toSt7565, true, first, second) && ok;
+	ok = measure<ControllerSsd1306, DisplayUsart>("ssd1306", ssd1306, toSsd1306, true, first, second) && ok;
+
+	st7565 = PageModel(PageModel::ST7565);
+	ssd1306 = PageModel(PageModel::SSD1306);
+	ok = measure<ControllerSt7565, DisplayUsartPipeline>("st7565", st7565, toSt7565, true, first, second) && ok;
+	ok = measure<ControllerSsd1306, DisplayUsartPipeline>("ssd1306", ssd1306, toSsd1306, true, first, second) && ok;
+
+	printf("\nfull frame, latency against SPI, bands of %d bytes\n", DISPLAY_BAND);
+	printf("driver   link   us_1MHz  us_8MHz  x_1MHz x_8MHz\n");
+	const char* drivers[] = { "st7565", "ssd1306" };
+	const char* links[] = { "spi", "usart", "bands" };
+	for(int d = 0; d < 2; d++)
+		for(int l = 0; l < 3; l++)
+			printf("%-8s %-6s %-8.0f %-8.0f %-6.2f %-6.2f\n", drivers[d], links[l], latency[d][l][0],
+					latency[d][l][1], latency[d][l][0] / latency[d][0][0], latency[d][l][1] / latency[d][0][1]);
+
+	return ok ? 0 : 1;
+}
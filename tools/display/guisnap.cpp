@@ -0,0 +1,135 @@
+/*
+ * Snapshots of the CodAlarm screen, from the bytes the firmware sends to the display controller.
+ *
+ * Runs the firmware GUI (CodAlarm/core/GUI.cpp) and display driver on the host build, with the
+ * SPI bus connected to a model of the ST7920 (St7920.h). The GUI draws a sequence of frames: boot,
+ * each state of t_state, 12 hour mode, alarm switch off, stale clock; the digits being set are
+ * caught in the hidden half of their blink. Frames are incremental, as on the device: each one only
+ * sends what changed since the previous.
+ *
+ * For each frame the panel image is written as a PBM file, and the bytes received are counted:
+ * commands, data bytes, redundant data bytes (already in GDRAM) and errors. With a directory of
+ * golden images, each image is compared with the file of the same name.
+ *
+ * Usage: guisnap [output_dir [golden_dir]]		default: current directory, no comparison
+ *        exit status 1 if an image differs from its golden image or the controller saw errors
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "constants.h"
+#include "core/CodAlarm.h"
+#include "core/GUI.h"
+
+#include <avr/io.h>
+
+#include "St7920.h"
+
+static St7920 panel;
+
+static void spi(uint8_t c) {
+	panel.receive(c, PORT(PORT_DISPLAY_A0) & (1 << LINE_DISPLAY_A0));
+}
+
+/** Frame of the sequence. */
+struct t_frame {
+	const char* name;
+	t_state state;
+	t_mode mode;
+	bool on;
+	bool stale;
+	/** Blink phase: false hides the digits being set. */
+	bool blink;
+};
+
+static const t_frame FRAMES[] = {
+	{ "boot",		IDLE,		H24,	true,	false,	true },
+	{ "idle",		IDLE,		H24,	true,	false,	false },
+	{ "set_clock1",	SET_CLOCK1,	H24,	true,	false,	false },
+	{ "set_clock2",	SET_CLOCK2,	H24,	true,	false,	false },
+	{ "set_alarm1",	SET_ALARM1,	H24,	true,	false,	false },
+	{ "set_alarm2",	SET_ALARM2,	H24,	true,	false,	false },
+	{ "ring",		RING,		H24,	true,	false,	false },
+	{ "idle_12h",	IDLE,		H12,	true,	false,	true },
+	{ "switch_off",	IDLE,		H12,	false,	false,	true },
+	{ "stale",		IDLE,		H24,	true,	true,	false },
+	{ "idle_again",	IDLE,		H24,	true,	false,	true },
+};
+
+/** Reads a whole file, empty if missing. */
+static std::vector<char> slurp(const std::string& path) {
+	std::vector<char> content;
+	FILE* f = fopen(path.c_str(), "rb");
+	if(!f)
+		return content;
+
+	char buffer[4096];
+	size_t n;
+	while((n = fread(buffer, 1, sizeof(buffer), f)) > 0)
+		content.insert(content.end(), buffer, buffer + n);
+	fclose(f);
+	return content;
+}
+
+int main(int argc, char** argv) {
+	std::string output = argc > 1 ? argv[1] : ".";
+	const char* golden = argc > 2 ? argv[2] : NULL;
+	bool ok = true;
+
+	CodAlarm ca;
+	GUI gui(&ca);
+
+	PORT(PORT_DISPLAY_A0) = 0;
+	host_spi_hook = spi;
+
+	// Display reset, empty buffer: the first frame sends everything
+	ca.display.init();
+
+	ca.clock.setValue(10 * H_SEC + 42 * M_SEC);
+	ca.alarm.setValue(7 * H_SEC + 30 * M_SEC);
+
+	printf("frame        commands  data  redundant  errors  lit   golden\n");
+	for(const t_frame& frame : FRAMES) {
+		ca.state = frame.state;
+		ca.mode = frame.mode;
+		ca.stale = frame.stale;
+		PIN(PORT_SWITCH) = frame.on ? 1 << LINE_SWITCH : 0;
+		host_timer1_count = frame.blink ? TIMER1_CMP : 0;
+
+		// Boot includes the controller reset
+		if(&frame != FRAMES)
+			panel.resetCounts();
+		gui.draw();
+
+		std::string name = std::string(frame.name) + ".pbm";
+		std::string path = output + "/" + name;
+		FILE* f = fopen(path.c_str(), "wb");
+		if(!f || !panel.writePbm(f)) {
+			fprintf(stderr, "can't write %s\n", path.c_str());
+			return 1;
+		}
+		fclose(f);
+
+		const char* status = "";
+		if(golden) {
+			std::vector<char> expected = slurp(std::string(golden) + "/" + name);
+			if(expected.empty())
+				status = "missing";
+			else if(expected != slurp(path))
+				status = "DIFFERS";
+			else
+				status = "ok";
+			ok = ok && expected == slurp(path);
+		}
+
+		const St7920::t_counts& c = panel.counts;
+		ok = ok && !c.errors;
+		printf("%-12s %-9u %-5u %-10u %-7u %-5u %s\n", frame.name, c.commands, c.data, c.redundant,
+				c.errors, panel.lit(), status);
+	}
+
+	return ok ? 0 : 1;
+}
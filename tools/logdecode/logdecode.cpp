@@ -0,0 +1,98 @@
+/*
+ * Decodes the CodAlarm event log dump into CSV.
+ *
+ * The dump is what the firmware sends for the "log" console command (see EventLog::dump()):
+ *
+ *     # log <count>
+ *     1005 2003 ...
+ *     # end
+ *
+ * Lines not between "# log" and "# end" are ignored, so a raw capture of the serial port can be
+ * fed directly. Output columns:
+ *
+ *     day,time,event,delta
+ *
+ * day counts the midnights since the last boot, time is the clock time (HH:MM) and delta the
+ * minutes since the previous event. Times before the first anchor (boot or time set) are empty.
+ *
+ * Build: g++ -std=c++11 -I ../../CodAlarm/core -o logdecode logdecode.cpp
+ * Usage: logdecode < dump.txt > log.csv
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "LogFormat.h"
+
+static const char* names[] = {
+	"boot", "time_set", "alarm", "snooze", "stop", "switch_off", "gap", "erased"
+};
+
+int main() {
+	char line[1024];
+	bool in_log = false;
+	int day = 0;
+	long time = -1;		// Minutes from midnight, -1 if unknown
+
+	printf("day,time,event,delta\n");
+
+	while(fgets(line, sizeof(line), stdin)) {
+		if(strncmp(line, "# log", 5) == 0) {
+			in_log = true;
+			continue;
+		}
+		if(strncmp(line, "# end", 5) == 0) {
+			in_log = false;
+			continue;
+		}
+		if(!in_log)
+			continue;
+
+		char* p = line;
+		char* end;
+		for(;;) {
+			unsigned long record = strtoul(p, &end, 16);
+			if(end == p)
+				break;
+			p = end;
+
+			t_log_type type = log_type(record);
+			uint16_t value = log_value(record);
+			uint16_t delta = 0;
+
+			switch(type) {
+			case LOG_BOOT:
+				day = 0;
+				time = value;
+				break;
+
+			case LOG_TIME_SET:
+				time = value;
+				break;
+
+			case LOG_ERASED:
+				continue;
+
+			default:
+				delta = value;
+				if(time >= 0) {
+					time += value;
+					day += time / 1440;
+					time %= 1440;
+				}
+				break;
+			}
+
+			if(type == LOG_GAP)
+				continue;
+
+			if(time >= 0)
+				printf("%d,%02ld:%02ld,%s,%u\n", day, time / 60, time % 60, names[type], delta);
+			else
+				printf("%d,,%s,%u\n", day, names[type], delta);
+		}
+	}
+
+	return 0;
+}
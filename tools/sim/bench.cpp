@@ -0,0 +1,389 @@
+/*
+ * Cycle counts of the CodAlarm firmware in simavr, compared against a baseline.
+ *
+ * Runs the firmware image through a scripted session: boot, two presses of MODE (12/24 h, always
+ * redrawn), a long press of SET_CLOCK and a few seconds of blinking digits while setting the clock.
+ * Every instruction is stepped, and the cycles of each call of the functions and interrupts below
+ * are counted from their first instruction to their return, symbols taken from the ELF file:
+ * - functions exclude the interrupt handlers that ran in between, not the few cycles of the
+ *   interrupt response and vector jump;
+ * - interrupts exclude the response and the vector jump, 7 cycles, and include the prologue.
+ * The button to pixel latency runs from the button going low to the end of the first display
+ * update that sends something afterwards, debounce included.
+ *
+ * At the end the painted RAM (CodAlarm/hw/Stack.h) gives the stack headroom of the session.
+ *
+ * The results are written to standard output as JSON, and a report to standard error. With a
+ * baseline, a file written by an earlier run, the program fails if a mean or a max is more than
+ * the tolerance above the baseline, if a measured section is missing, or if the headroom is below
+ * STACK_MIN_HEADROOM. A section measured now must have numbers in the baseline: a section the
+ * baseline doesn't list, or lists as never run (null), fails too, so an empty or placeholder
+ * baseline never passes. A section run neither then nor now is reported only.
+ *
+ * No baseline is kept in the tree yet: it must be the results of a real run, of a firmware built
+ * with avr-gcc, and without one `make bench` only reports. The baseline is refreshed by writing
+ * the results of a new run over it.
+ *
+ * The firmware must be built without PROFILE and TRACE, with the same compiler as the baseline.
+ *
+ * Build: g++ -std=c++11 -o bench bench.cpp -lsimavr -lelf
+ * Usage: bench firmware.elf [baseline.json [tolerance_%]] > results.json	default tolerance: 5 %
+ *        exit status 1 on a regression, a crash or a low stack headroom
+ */
+
+#include <cxxabi.h>
+#include <fcntl.h>
+#include <fnmatch.h>
+#include <gelf.h>
+#include <libelf.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <simavr/sim_avr.h>
+#include <simavr/sim_elf.h>
+#include <simavr/avr_ioport.h>
+#include <simavr/avr_spi.h>
+
+#define STACK_CANARY		0xC5		// hw/Stack.h
+#define STACK_MIN_HEADROOM	64			// constants.h
+#define DATA_OFFSET			0x800000	// Data space addresses in the ELF file
+
+/**
+ * Section measured: a function, by demangled name, or an interrupt, by vector symbol. Names are
+ * fnmatch() patterns, for the templates: the first symbol matching is taken.
+ */
+struct t_section {
+	const char* key;
+	const char* symbol;
+	bool isr;
+};
+
+static const t_section SECTIONS[] = {
+	{ "clock_tick",		"Clock::tick()",						false },
+	{ "draw_symbol",	"GUI::_drawSymbol(int, int, t_symbol, int)",	false },
+	{ "gui_draw",		"GUI::draw()",							false },
+	{ "display_update",	"DisplayDriver<*>::update()",			false },
+	{ "isr_timer0",		"__vector_16",							true },
+	{ "isr_timer1",		"__vector_11",							true },
+	{ "isr_timer2",		"__vector_7",							true },
+	{ "isr_usart_rx",	"__vector_18",							true },
+	{ "isr_usart_udre",	"__vector_19",							true },
+	{ "isr_usart_tx",	"__vector_20",							true },
+	{ "isr_ee_ready",	"__vector_22",							true },
+};
+
+#define N_SECTIONS		(sizeof(SECTIONS) / sizeof(SECTIONS[0]))
+#define DISPLAY_UPDATE	3			// Index of DisplayDriver::update() in SECTIONS
+
+/** Button press of the session. */
+struct t_press {
+	double ms;
+	double release_ms;
+	char port;
+	int line;
+	/** Counted in the button to pixel latency: the press always changes the display. */
+	bool measure;
+};
+
+static const t_press SCRIPT[] = {
+	{ 2000, 2100, 'D', 6, true },		// MODE: 12 h
+	{ 2500, 2600, 'D', 6, true },		// MODE: 24 h
+	{ 3000, 5500, 'C', 1, false },		// SET_CLOCK long: SET_CLOCK1, hours blink
+	{ 7000, 7100, 'C', 1, false },		// SET_CLOCK: SET_CLOCK2, minutes blink
+	{ 8500, 8600, 'D', 2, false },		// SET_ALARM: back to IDLE
+};
+
+#define SESSION_MS		9500
+
+/** Inputs held high: buttons (active low, released) and the switch (alarm on). */
+static const struct { char port; int line; } INPUTS[] = {
+	{ 'C', 1 }, { 'D', 2 }, { 'D', 3 }, { 'D', 4 }, { 'D', 5 }, { 'D', 6 }, { 'D', 7 }, { 'C', 0 },
+};
+
+/** Cycles of the runs of a section. */
+struct t_stats {
+	unsigned long count = 0;
+	unsigned long long min = ~0ULL, max = 0, sum = 0;
+
+	void add(unsigned long long cycles) {
+		count++;
+		sum += cycles;
+		if(cycles < min)
+			min = cycles;
+		if(cycles > max)
+			max = cycles;
+	}
+};
+
+/** Call in progress. */
+struct t_frame {
+	int section;
+	uint16_t sp;
+	avr_cycle_count_t start;
+	/** Cycles of the interrupt handlers run during the call. */
+	avr_cycle_count_t interrupted;
+	uint32_t spi_bytes;
+};
+
+static uint32_t spi_bytes = 0;
+
+static void spi_output(avr_irq_t*, uint32_t, void*) {
+	spi_bytes++;
+}
+
+/**
+ * Reads the symbol table of an ELF file.
+ * \return demangled names and addresses, empty if unreadable
+ */
+static std::map<std::string, uint32_t> read_symbols(const char* path) {
+	std::map<std::string, uint32_t> symbols;
+
+	int fd = open(path, O_RDONLY);
+	if(fd < 0 || elf_version(EV_CURRENT) == EV_NONE)
+		return symbols;
+
+	Elf* elf = elf_begin(fd, ELF_C_READ, NULL);
+	Elf_Scn* scn = NULL;
+	while(elf && (scn = elf_nextscn(elf, scn))) {
+		GElf_Shdr header;
+		if(!gelf_getshdr(scn, &header) || header.sh_type != SHT_SYMTAB)
+			continue;
+
+		Elf_Data* data = elf_getdata(scn, NULL);
+		for(size_t i = 0; data && i < header.sh_size / header.sh_entsize; i++) {
+			GElf_Sym sym;
+			gelf_getsym(data, i, &sym);
+			const char* name = elf_strptr(elf, header.sh_link, sym.st_name);
+			if(!name || !*name)
+				continue;
+
+			int status;
+			char* demangled = abi::__cxa_demangle(name, NULL, NULL, &status);
+			symbols[status == 0 ? demangled : name] = (uint32_t) sym.st_value;
+			free(demangled);
+		}
+	}
+
+	if(elf)
+		elf_end(elf);
+	close(fd);
+	return symbols;
+}
+
+/**
+ * Reads a value of a section in a baseline file written by this program.
+ * \return false if missing or null
+ */
+static bool baseline_value(const std::string& baseline, const char* key, const char* field, double* value) {
+	size_t at = baseline.find(std::string("\"") + key + "\"");
+	if(at == std::string::npos)
+		return false;
+
+	size_t end = baseline.find('}', at);
+	at = baseline.find(std::string("\"") + field + "\":", at);
+	if(at == std::string::npos || at > end)
+		return false;
+
+	const char* text = baseline.c_str() + at + strlen(field) + 3;
+	char* after;
+	*value = strtod(text, &after);
+	return after != text;
+}
+
+static uint16_t sp_get(avr_t* avr) {
+	return avr->data[R_SPL] | (avr->data[R_SPH] << 8);
+}
+
+static avr_irq_t* pin(avr_t* avr, char port, int line) {
+	return avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ(port), line);
+}
+
+int main(int argc, char** argv) {
+	if(argc < 2) {
+		fprintf(stderr, "usage: %s firmware.elf [baseline.json [tolerance_%%]]\n", argv[0]);
+		return 2;
+	}
+
+	double tolerance = argc > 3 ? atof(argv[3]) : 5;
+
+	std::string baseline;
+	if(argc > 2) {
+		std::ifstream in(argv[2]);
+		if(!in) {
+			fprintf(stderr, "can't read %s\n", argv[2]);
+			return 2;
+		}
+		std::stringstream text;
+		text << in.rdbuf();
+		baseline = text.str();
+	}
+
+	std::map<std::string, uint32_t> symbols = read_symbols(argv[1]);
+
+	elf_firmware_t firmware;
+	memset(&firmware, 0, sizeof(firmware));
+	if(symbols.empty() || elf_read_firmware(argv[1], &firmware) != 0) {
+		fprintf(stderr, "can't read %s\n", argv[1]);
+		return 1;
+	}
+
+	// Same defaults as the firmware (constants.h) when the ELF doesn't say
+	if(!firmware.frequency)
+		firmware.frequency = 1000000;
+	if(!firmware.mmcu[0])
+		strcpy(firmware.mmcu, "atmega328p");
+
+	avr_t* avr = avr_make_mcu_by_name(firmware.mmcu);
+	if(!avr) {
+		fprintf(stderr, "unknown MCU %s\n", firmware.mmcu);
+		return 1;
+	}
+	avr_init(avr);
+	avr_load_firmware(avr, &firmware);
+
+	for(auto& in : INPUTS)
+		avr_raise_irq(pin(avr, in.port, in.line), 1);
+	avr_irq_register_notify(avr_io_getirq(avr, AVR_IOCTL_SPI_GETIRQ(0), SPI_IRQ_OUTPUT), spi_output, NULL);
+
+	// Entry points, 0 for the sections not in the image (inlined or removed)
+	uint32_t entry[N_SECTIONS];
+	for(size_t i = 0; i < N_SECTIONS; i++) {
+		entry[i] = 0;
+		for(auto& symbol : symbols)
+			if(fnmatch(SECTIONS[i].symbol, symbol.first.c_str(), 0) == 0) {
+				entry[i] = symbol.second;
+				break;
+			}
+	}
+
+	auto cycles = [&](double ms) { return (avr_cycle_count_t) (ms * firmware.frequency / 1000); };
+
+	t_stats stats[N_SECTIONS];
+	t_stats latency;
+	std::vector<t_frame> calls;
+	avr_cycle_count_t pressed = 0;		// Measured press waiting for a redraw, 0 if none
+	size_t next_press = 0, next_release = 0;
+	avr_cycle_count_t end = cycles(SESSION_MS);
+	int state = cpu_Running;
+
+	while(avr->cycle < end && state != cpu_Done && state != cpu_Crashed) {
+		// Script
+		if(next_press < sizeof(SCRIPT) / sizeof(SCRIPT[0]) && avr->cycle >= cycles(SCRIPT[next_press].ms)) {
+			const t_press& press = SCRIPT[next_press++];
+			avr_raise_irq(pin(avr, press.port, press.line), 0);
+			if(press.measure)
+				pressed = avr->cycle;
+		}
+		if(next_release < next_press && avr->cycle >= cycles(SCRIPT[next_release].release_ms)) {
+			const t_press& press = SCRIPT[next_release++];
+			avr_raise_irq(pin(avr, press.port, press.line), 1);
+		}
+
+		state = avr_run(avr);
+
+		// Returns: the stack pointer is back above the return address
+		uint16_t sp = sp_get(avr);
+		while(!calls.empty() && sp > calls.back().sp) {
+			t_frame call = calls.back();
+			calls.pop_back();
+
+			avr_cycle_count_t total = avr->cycle - call.start;
+			stats[call.section].add(total - call.interrupted);
+
+			if(SECTIONS[call.section].isr)
+				for(t_frame& outer : calls)
+					outer.interrupted += total;
+
+			if(call.section == DISPLAY_UPDATE && pressed && call.start > pressed && spi_bytes != call.spi_bytes) {
+				latency.add(avr->cycle - pressed);
+				pressed = 0;
+			}
+		}
+
+		// Calls: first instruction of a section
+		for(size_t i = 0; i < N_SECTIONS; i++)
+			if(entry[i] && avr->pc == entry[i])
+				calls.push_back({ (int) i, sp, avr->cycle, 0, spi_bytes });
+	}
+
+	if(state == cpu_Crashed) {
+		fprintf(stderr, "firmware crashed at cycle %llu\n", (unsigned long long) avr->cycle);
+		return 1;
+	}
+
+	// Painted bytes left above .bss
+	long headroom = -1;
+	auto bss_end = symbols.find("_end");
+	if(bss_end != symbols.end()) {
+		uint32_t at = bss_end->second - DATA_OFFSET;
+		headroom = 0;
+		while(at + headroom <= avr->ramend && avr->data[at + headroom] == STACK_CANARY)
+			headroom++;
+	}
+
+	// Results
+	printf("{\n\t\"firmware\": \"%s\",\n\t\"f_cpu\": %u,\n\t\"session_ms\": %d,\n\t\"cycles\": {\n",
+			argv[1], (unsigned) firmware.frequency, SESSION_MS);
+
+	bool ok = true;
+	fprintf(stderr, "%-16s %8s %8s %8s %8s %10s\n", "section", "count", "min", "mean", "max", "baseline");
+
+	for(size_t i = 0; i <= N_SECTIONS; i++) {
+		const char* key = i < N_SECTIONS ? SECTIONS[i].key : "button_to_pixel";
+		const t_stats& s = i < N_SECTIONS ? stats[i] : latency;
+		double mean = s.count ? (double) s.sum / s.count : 0;
+
+		if(s.count)
+			printf("\t\t\"%s\": { \"count\": %lu, \"min\": %llu, \"mean\": %.0f, \"max\": %llu }%s\n",
+					key, s.count, s.min, mean, s.max, i < N_SECTIONS ? "," : "");
+		else
+			printf("\t\t\"%s\": { \"count\": 0, \"min\": null, \"mean\": null, \"max\": null }%s\n",
+					key, i < N_SECTIONS ? "," : "");
+
+		// Against the baseline
+		const char* status = "";
+		double base_count, base_mean, base_max;
+		bool listed = !baseline.empty() && baseline_value(baseline, key, "count", &base_count);
+		bool based = listed && baseline_value(baseline, key, "max", &base_max)
+				&& baseline_value(baseline, key, "mean", &base_mean);
+
+		if(based && !s.count) {
+			status = "MISSING";
+			ok = false;
+		} else if(based && (mean > base_mean * (1 + tolerance / 100) || s.max > base_max * (1 + tolerance / 100))) {
+			status = "SLOWER";
+			ok = false;
+		} else if(based) {
+			status = "ok";
+		} else if(listed && !base_count && !s.count) {
+			status = "not run";
+		} else if(!baseline.empty()) {
+			status = "NO BASELINE";
+			ok = false;
+		}
+
+		if(s.count)
+			fprintf(stderr, "%-16s %8lu %8llu %8.0f %8llu ", key, s.count, s.min, mean, s.max);
+		else
+			fprintf(stderr, "%-16s %8d %8s %8s %8s ", key, 0, "-", "-", "-");
+		if(based)
+			fprintf(stderr, "%10.0f %s\n", base_max, status);
+		else
+			fprintf(stderr, "%10s %s\n", "-", status);
+	}
+
+	bool deep = headroom < STACK_MIN_HEADROOM;
+	ok = ok && !deep;
+	printf("\t},\n\t\"stack_headroom\": %ld\n}\n", headroom);
+	fprintf(stderr, "stack headroom %ld bytes, minimum %d %s\n", headroom, STACK_MIN_HEADROOM, deep ? "FAIL" : "ok");
+
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,97 @@
+/*
+ * Runs the CodAlarm firmware in simavr and records the trace pins (CodAlarm/hw/Trace.h) to a VCD
+ * file, for GTKWave.
+ *
+ * The firmware must be built with TRACE=1. The buttons are held released (high) and the alarm
+ * switch on; the display and the serial port are left unconnected. Besides the trace channels the
+ * file has the serial output (TXD) and the buzzer, to line the sections up with what they do.
+ *
+ * Build: g++ -std=c++11 -o vcdtrace vcdtrace.cpp -lsimavr -lelf
+ * Usage: vcdtrace firmware.elf [milliseconds] [file.vcd]		defaults: 3000 ms, trace.vcd
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <simavr/sim_avr.h>
+#include <simavr/sim_elf.h>
+#include <simavr/avr_ioport.h>
+#include <simavr/sim_vcd_file.h>
+
+// Pinout, see CodAlarm/constants.h
+struct t_signal {
+	char port;
+	int line;
+	const char* name;
+};
+
+static const t_signal SIGNALS[] = {
+	{ 'C', 4, "isr" },
+	{ 'B', 6, "frame" },
+	{ 'B', 7, "update" },
+	{ 'D', 1, "txd" },
+	{ 'B', 1, "buzzer" },
+};
+
+/** Inputs held high: buttons (active low, released) and the switch (alarm on). */
+static const t_signal INPUTS[] = {
+	{ 'C', 1, "set_clock" }, { 'D', 2, "set_alarm" }, { 'D', 3, "stop" }, { 'D', 4, "up" },
+	{ 'D', 5, "down" }, { 'D', 6, "mode" }, { 'D', 7, "snooze" }, { 'C', 0, "switch" },
+};
+
+int main(int argc, char** argv) {
+	if(argc < 2) {
+		fprintf(stderr, "usage: %s firmware.elf [milliseconds] [file.vcd]\n", argv[0]);
+		return 2;
+	}
+
+	double ms = argc > 2 ? atof(argv[2]) : 3000;
+	const char* output = argc > 3 ? argv[3] : "trace.vcd";
+
+	elf_firmware_t firmware;
+	memset(&firmware, 0, sizeof(firmware));
+	if(elf_read_firmware(argv[1], &firmware) != 0) {
+		fprintf(stderr, "can't read %s\n", argv[1]);
+		return 1;
+	}
+
+	// Same defaults as the firmware (constants.h) when the ELF doesn't say
+	if(!firmware.frequency)
+		firmware.frequency = 1000000;
+	if(!firmware.mmcu[0])
+		strcpy(firmware.mmcu, "atmega328p");
+
+	avr_t* avr = avr_make_mcu_by_name(firmware.mmcu);
+	if(!avr) {
+		fprintf(stderr, "unknown MCU %s\n", firmware.mmcu);
+		return 1;
+	}
+	avr_init(avr);
+	avr_load_firmware(avr, &firmware);
+
+	for(const t_signal& in : INPUTS)
+		avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ(in.port), in.line), 1);
+
+	avr_vcd_t vcd;
+	avr_vcd_init(avr, output, &vcd, 100000);
+	for(const t_signal& s : SIGNALS)
+		avr_vcd_add_signal(&vcd, avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ(s.port), s.line), 1, s.name);
+	avr_vcd_start(&vcd);
+
+	avr_cycle_count_t end = (avr_cycle_count_t) (ms * firmware.frequency / 1000);
+	int state = cpu_Running;
+	while(avr->cycle < end && state != cpu_Done && state != cpu_Crashed)
+		state = avr_run(avr);
+
+	avr_vcd_stop(&vcd);
+	avr_vcd_close(&vcd);
+
+	if(state == cpu_Crashed) {
+		fprintf(stderr, "firmware crashed at cycle %llu\n", (unsigned long long) avr->cycle);
+		return 1;
+	}
+
+	printf("%s: %.0f ms, %llu cycles\n", output, ms, (unsigned long long) avr->cycle);
+	return 0;
+}
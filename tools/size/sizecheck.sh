@@ -0,0 +1,53 @@
+#!/bin/sh
+#
+# Reports .text, .data and .bss of the CodAlarm firmware per module and checks them against a
+# budget file (see CodAlarm/size-budget.txt). Run by "make size" in CodAlarm.
+#
+# Usage: sizecheck.sh budget.txt firmware.elf module.o...		exit status 1 if over budget
+#
+# SIZE selects the size tool, avr-size by default.
+
+SIZE=${SIZE:-avr-size}
+
+if [ $# -lt 2 ]; then
+	echo "usage: $0 budget.txt firmware.elf module.o..." >&2
+	exit 2
+fi
+
+budget=$1
+elf=$2
+shift 2
+
+# Berkeley format: text data bss dec hex filename. The firmware is reported as "total".
+{
+	$SIZE -B "$@" | awk 'NR > 1 { n = split($6, p, "/"); sub(/\.o$/, "", p[n]); print p[n], $1, $2, $3 }'
+	$SIZE -B "$elf" | awk 'NR > 1 { print "total", $1, $2, $3 }'
+} | awk -v budget="$budget" '
+	BEGIN {
+		while((getline line < budget) > 0) {
+			if(line ~ /^[ \t]*(#|$)/)
+				continue
+			split(line, f)
+			limit[f[1], 1] = f[2]; limit[f[1], 2] = f[3]; limit[f[1], 3] = f[4]
+			listed[f[1]] = 1
+		}
+		printf "%-16s %8s %8s %8s\n", "module", "text", "data", "bss"
+	}
+	{
+		line = sprintf("%-16s", $1)
+		for(i = 1; i <= 3; i++) {
+			cell = $(i + 1)
+			if(($1 in listed) && limit[$1, i] != "-" && $(i + 1) + 0 > limit[$1, i] + 0) {
+				cell = cell ">" limit[$1, i]
+				over++
+			}
+			line = line sprintf(" %8s", cell)
+		}
+		print line
+	}
+	END {
+		if(over) {
+			printf "%d size budget(s) exceeded\n", over
+			exit 1
+		}
+	}'
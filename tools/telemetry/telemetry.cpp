@@ -0,0 +1,131 @@
+/*
+ * Prints the CodAlarm telemetry stream (see CodAlarm/core/TelemetryFormat.h) as live stats.
+ *
+ * Start the stream with the "telemetry on" console command. Frames are read from the serial port
+ * given as argument, or from stdin (e.g. a capture file). One line is printed per frame:
+ *
+ *     #12 up 5m loop 830/s max 1.28ms | t0 max 40us t1 max 128us | redraw 3/s update 1/s 96B/s | lost rx 0 tx 0 log 0 | bad 0
+ *
+ * Rates are differences between two frames over the frame period. Console text sent between
+ * frames goes to stderr; frames failing the CRC are counted as bad.
+ *
+ * Build: g++ -std=c++11 -I ../../CodAlarm/core -o telemetry telemetry.cpp
+ * Usage: telemetry [/dev/ttyUSB0 [baud [period]]]
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "Frame.h"
+#include "TelemetryFormat.h"
+
+static speed_t baud_flag(long baud) {
+	switch(baud) {
+	case 2400:		return B2400;
+	case 4800:		return B4800;
+	case 9600:		return B9600;
+	case 19200:		return B19200;
+	case 38400:		return B38400;
+	case 57600:		return B57600;
+	case 115200:	return B115200;
+	default:
+		fprintf(stderr, "unsupported baud rate %ld\n", baud);
+		exit(2);
+	}
+}
+
+static int open_port(const char* path, long baud) {
+	int fd = open(path, O_RDONLY | O_NOCTTY);
+	if(fd < 0) {
+		perror(path);
+		exit(2);
+	}
+
+	struct termios tio;
+	if(tcgetattr(fd, &tio) == 0) {
+		cfmakeraw(&tio);
+		cfsetispeed(&tio, baud_flag(baud));
+		cfsetospeed(&tio, baud_flag(baud));
+		tio.c_cc[VMIN] = 1;
+		tio.c_cc[VTIME] = 0;
+		tcsetattr(fd, TCSANOW, &tio);
+	}
+	return fd;
+}
+
+/** Converts timer ticks to microseconds. */
+static double ticks_us(const t_telemetry& t, uint16_t div, uint16_t ticks) {
+	return ticks * (double) div * 1000.0 / t.cpu_khz;
+}
+
+static void print_frame(const t_telemetry& t, const t_telemetry* prev, double period, unsigned bad) {
+	// Rates need the previous frame, and no frame lost in between
+	bool rates = prev && (uint8_t) (t.seq - prev->seq) == 1;
+	double d = period;
+
+	printf("#%u up %um", t.seq, t.uptime);
+	if(rates)
+		printf(" loop %.0f/s", (uint16_t) (t.loops - prev->loops) / d);
+	printf(" max %.2fms", ticks_us(t, t.t1_div, t.loop_max) / 1000.0);
+	printf(" | t0 max %.0fus t1 max %.0fus", ticks_us(t, t.t0_div, t.t0_max), ticks_us(t, t.t1_div, t.t1_max));
+	if(rates)
+		printf(" | redraw %.0f/s update %.0f/s %.0fB/s", (uint16_t) (t.redraws - prev->redraws) / d,
+				(uint16_t) (t.updates - prev->updates) / d, (uint16_t) (t.display_bytes - prev->display_bytes) / d);
+	printf(" | lost rx %u tx %u log %u | stack %u | bad %u\n", t.rx_lost, t.tx_lost, t.log_dropped,
+			t.stack_headroom, bad);
+	fflush(stdout);
+}
+
+int main(int argc, char** argv) {
+	int fd = argc > 1 ? open_port(argv[1], argc > 2 ? atol(argv[2]) : 9600) : 0;
+	double period = argc > 3 ? atof(argv[3]) : 1.0;
+
+	uint8_t chunk[255];
+	int n = 0;
+	bool overflow = false;
+	unsigned bad = 0;
+	t_telemetry prev;
+	bool have_prev = false;
+
+	uint8_t buf[64];
+	ssize_t got;
+	while((got = read(fd, buf, sizeof(buf))) > 0) {
+		for(ssize_t k = 0; k < got; k++) {
+			if(buf[k] != 0) {
+				if(n < (int) sizeof(chunk))
+					chunk[n++] = buf[k];
+				else
+					overflow = true;
+				continue;
+			}
+
+			// Delimiter: chunk is a frame or console text
+			uint8_t frame[256];
+			int m = (n > 0 && !overflow) ? frame_decode(chunk, n, frame) : -1;
+			bool valid = m == (int) sizeof(t_telemetry) && frame[0] == TELEMETRY_COUNTERS;
+
+			// Frame sized but failing the CRC: damaged frame
+			if(m < 0 && !overflow && n == (int) sizeof(t_telemetry) + 3)
+				bad++;
+
+			if(valid) {
+				t_telemetry t;
+				memcpy(&t, frame, sizeof(t));
+				print_frame(t, have_prev ? &prev : NULL, period, bad);
+				prev = t;
+				have_prev = true;
+			} else if(n > 0) {
+				fwrite(chunk, 1, n, stderr);
+			}
+
+			n = 0;
+			overflow = false;
+		}
+	}
+
+	return 0;
+}
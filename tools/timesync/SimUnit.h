@@ -0,0 +1,62 @@
+/*
+ * Simulated CodAlarm unit for the time synchronisation simulations (loopback.cpp, timebus.cpp):
+ * Timer1 ticks with a frequency error, each second lasts as long as the firmware clock discipline
+ * (CodAlarm/core/TimeDiscipline.cpp) says, and timestamps are quantised as in TimeSync.
+ */
+
+#ifndef SIMUNIT_H_
+#define SIMUNIT_H_
+
+#include <cstdlib>
+
+#include "SyncFormat.h"
+#include "TimeDiscipline.h"
+
+// Firmware configuration at F_CPU = 1 MHz, UART_BAUD = 9600 (see constants.h)
+#define TICKS			15625		// Timer1 ticks per second
+#define TICK_US			64.0		// Timer1 tick, nominal
+#define SLEW_TICKS		78			// SYNC_SLEW_PPM = 5000
+#define STEP_MS			2000
+#define DELAY_MAX		100
+#define BYTE_US			1041		// 10 bits at 9600 baud
+
+/** Simulated unit: clock seconds counted by Timer1. */
+struct Unit {
+	TimeDiscipline discipline;
+	double tick_us;					// Real tick length
+	long seconds;					// Clock value
+	double start;					// Start of the current second, real time in us
+	uint16_t top;					// OCR1A of the current second
+	uint32_t uptime;
+
+	Unit(double ppm, long initial) : discipline(TICKS, SLEW_TICKS, STEP_MS, DELAY_MAX) {
+		tick_us = TICK_US / (1 + ppm / 1e6);
+		seconds = initial;
+		start = 0;
+		top = TICKS - 1;
+		uptime = 0;
+	}
+
+	/** Runs the Timer1 interrupts up to real time t. */
+	void advance(double t) {
+		while(t >= start + (top + 1) * tick_us) {
+			start += (top + 1) * tick_us;
+			top = TICKS - 1 - discipline.tick();
+			seconds = (seconds + 1) % (SYNC_DAY_MS / 1000);
+			uptime++;
+		}
+	}
+
+	/** Timestamp at real time t, as TimeSync::_ms(). */
+	int32_t ms(double t) {
+		advance(t);
+		uint32_t count = (uint32_t) ((t - start) / tick_us);
+		return seconds * 1000 + count * 1000 / ((uint32_t) top + 1);
+	}
+};
+
+static inline double uniform(double a, double b) {
+	return a + (b - a) * rand() / RAND_MAX;
+}
+
+#endif /* SIMUNIT_H_ */
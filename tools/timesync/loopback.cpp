@@ -0,0 +1,105 @@
+/*
+ * Loopback simulation of the CodAlarm time synchronisation.
+ *
+ * Runs the firmware clock discipline (CodAlarm/core/TimeDiscipline.cpp) against a simulated unit
+ * and host: Timer1 ticks with a frequency error, the seconds are stretched as the discipline says,
+ * timestamps are quantised as in TimeSync, and the serial link adds random latency on both
+ * sides. After a settling time the error between the unit clock and the host clock is sampled
+ * every second; the program fails if it ever exceeds the limit. Frequency errors up to
+ * SYNC_SLEW_PPM can be corrected.
+ *
+ * Build: g++ -std=c++11 -I ../../CodAlarm/core -o loopback loopback.cpp ../../CodAlarm/core/TimeDiscipline.cpp
+ * Usage: loopback [limit_ms]		exit status 1 if a scenario fails
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+#include "SimUnit.h"
+
+#define PERIOD			64			// SYNC_PERIOD
+#define RESPONSE_BYTES	15			// t_sync_response frame, delimiters included
+
+/** Host clock: the reference, real time. */
+static int32_t host_ms(double t) {
+	return (int32_t) fmod(floor(t / 1000), SYNC_DAY_MS);
+}
+
+/**
+ * Runs a scenario.
+ * \return largest error after settling, ms
+ */
+static double run(double ppm, long initial_offset_ms, double hours, double settle_hours, int* steps) {
+	long initial = ((-initial_offset_ms / 1000) % 86400 + 86400) % 86400;
+	Unit unit(ppm, initial);
+	double t = 0;
+	double worst = 0;
+	double next_sync = uniform(0, 1e6);
+
+	*steps = 0;
+
+	// Start of the simulation: unit second 0 at real time 0 minus the sub-second offset
+	unit.start = -(double) (initial_offset_ms % 1000) * 1000;
+
+	// Exchange in progress: real times of its events, in order
+	bool waiting = false;
+	double t2 = 0, t3 = 0, t4_end = 0;
+	int32_t T1 = 0;
+
+	for(double end = hours * 3600e6; t < end; t += 1e6) {
+		// Events before the next sample, in time order: the unit can't go back in time
+		for(;;) {
+			if(!waiting && next_sync < t) {
+				// Request ends at t1, host latencies, response on the wire
+				T1 = unit.ms(next_sync);
+				t2 = next_sync + uniform(1000, 8000);
+				t3 = t2 + uniform(100, 500);
+				t4_end = t3 + uniform(1000, 8000) + RESPONSE_BYTES * BYTE_US;
+				waiting = true;
+			} else if(waiting && t4_end < t) {
+				int32_t T4 = unit.ms(t4_end) - RESPONSE_BYTES * BYTE_US / 1000;
+
+				if(unit.discipline.update(T1, host_ms(t2), host_ms(t3), T4, unit.uptime) == SYNC_STEP) {
+					unit.seconds = ((unit.seconds + unit.discipline.getStep()) % 86400 + 86400) % 86400;
+					(*steps)++;
+				}
+
+				next_sync = t4_end + PERIOD * 1e6 * (1 + uniform(0, 0.01));
+				waiting = false;
+			} else {
+				break;
+			}
+		}
+
+		// Error sampled every second
+		if(t >= settle_hours * 3600e6) {
+			double error = sync_wrap(unit.ms(t) - host_ms(t));
+			if(fabs(error) > worst)
+				worst = fabs(error);
+		}
+	}
+
+	return worst;
+}
+
+int main(int argc, char** argv) {
+	double limit = argc > 1 ? atof(argv[1]) : 10;
+	bool ok = true;
+
+	struct { double ppm; long offset_ms; } scenarios[] = {
+		{ 0, 0 }, { 50, 1500 }, { -50, -1500 }, { 300, 40000 }, { -2000, -3600000 }, { 4500, 250 },
+	};
+
+	srand(1);
+	printf("ppm      offset_ms  steps  max_error_ms\n");
+	for(auto& s : scenarios) {
+		int steps;
+		double worst = run(s.ppm, s.offset_ms, 6, 1, &steps);
+		bool pass = worst < limit;
+		ok = ok && pass;
+		printf("%-8.0f %-10ld %-6d %-6.1f %s\n", s.ppm, s.offset_ms, steps, worst, pass ? "ok" : "FAIL");
+	}
+
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,98 @@
+/*
+ * Simulation of a CodAlarm time bus: one master and many slaves on a shared line.
+ *
+ * The master sends a beacon at BUS_SECOND of each minute of its own clock, after a random main
+ * loop latency; its clock runs free with its own frequency error. Each slave has a random
+ * frequency error and initial offset, receives the opening delimiter of the beacon after a random
+ * interrupt latency and disciplines its clock as TimeSync does. Every simulated second the error
+ * of each slave against the master is sampled: the table shows how the bus converges, and the
+ * program fails if any slave is off by more than the limit after the settling time.
+ *
+ * Build: g++ -std=c++11 -I ../../CodAlarm/core -o timebus timebus.cpp ../../CodAlarm/core/TimeDiscipline.cpp
+ * Usage: timebus [nodes] [limit_ms]		exit status 1 if the bus doesn't converge
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "SimUnit.h"
+
+#define BUS_SECOND		30			// constants.h
+#define BEACON_BYTES	10			// t_sync_beacon frame, delimiters included
+#define HOURS			12
+#define SETTLE_HOURS	1
+
+int main(int argc, char** argv) {
+	int nodes = argc > 1 ? atoi(argv[1]) : 48;
+	double limit = argc > 2 ? atof(argv[2]) : 10;
+
+	srand(1);
+
+	Unit master(uniform(-100, 100), (long) uniform(0, 86400));
+	master.start = -uniform(0, 1e6);
+
+	// Slaves: frequency errors up to SYNC_SLEW_PPM, any time of day
+	std::vector<Unit> slaves;
+	for(int i = 0; i < nodes; i++) {
+		slaves.push_back(Unit(uniform(-4500, 4500), (long) uniform(0, 86400)));
+		slaves.back().start = -uniform(0, 1e6);
+	}
+
+	long minute = -1;
+	long beacons = 0;
+	int steps = 0;
+	double worst = 0;
+
+	printf("minutes  beacons  max_error_ms  rms_error_ms  within_limit\n");
+
+	for(long second = 0; second < HOURS * 3600L; second++) {
+		double t = second * 1e6;
+
+		// Error of each slave
+		double max_error = 0, sum = 0;
+		int within = 0;
+		int32_t reference = master.ms(t);
+		for(Unit& slave : slaves) {
+			double error = fabs((double) sync_wrap(slave.ms(t) - reference));
+			max_error = fmax(max_error, error);
+			sum += error * error;
+			within += error < limit;
+		}
+
+		if(second >= SETTLE_HOURS * 3600L)
+			worst = fmax(worst, max_error);
+
+		if(second % 3600 == 0 || (second < 3600 && second % 600 == 0))
+			printf("%-8ld %-8ld %-13.0f %-13.1f %d/%d\n", second / 60, beacons, max_error,
+					sqrt(sum / nodes), within, nodes);
+
+		// Beacon, once a minute: the next sample is a second away, events stay in time order
+		if(master.seconds % 60 < BUS_SECOND || master.seconds / 60 == minute)
+			continue;
+
+		double sent = t + uniform(0, 20000);		// Main loop latency
+		int32_t time = master.ms(sent);
+		double line = sent + uniform(0, 50);		// Transmit interrupt latency
+		minute = master.seconds / 60;
+		beacons++;
+
+		for(Unit& slave : slaves) {
+			// Opening delimiter received, then the receive interrupt takes the stamp
+			double opening = line + BYTE_US + uniform(10, 100);
+			int32_t start = slave.ms(opening) - BYTE_US / 1000;
+
+			if(slave.discipline.update(start, time, time, start, slave.uptime) == SYNC_STEP) {
+				slave.seconds = ((slave.seconds + slave.discipline.getStep()) % 86400 + 86400) % 86400;
+				steps++;
+			}
+		}
+	}
+
+	bool ok = worst < limit;
+	printf("%d slaves, %ld beacons (%ld bytes on the line), %d steps, max error after %d h: %.0f ms %s\n",
+			nodes, beacons, beacons * BEACON_BYTES, steps, SETTLE_HOURS, worst, ok ? "ok" : "FAIL");
+
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,136 @@
+/*
+ * Host time server for CodAlarm (see CodAlarm/core/SyncFormat.h).
+ *
+ * Opens the serial port, enables synchronisation with the "sync on" console command, and answers
+ * each t_sync_request with the host local time. Console text from the unit is copied to stdout,
+ * other binary frames (telemetry) are skipped.
+ * The host clock should itself be synchronised (NTP): CodAlarm follows it within a few ms.
+ *
+ * Build: g++ -std=c++11 -I ../../CodAlarm/core -o timesyncd timesyncd.cpp
+ * Usage: timesyncd /dev/ttyUSB0 [baud]
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "Frame.h"
+#include "SyncFormat.h"
+
+/** Host local time, milliseconds from midnight. */
+static int32_t now_ms() {
+	struct timespec ts;
+	clock_gettime(CLOCK_REALTIME, &ts);
+
+	struct tm local;
+	localtime_r(&ts.tv_sec, &local);
+
+	return ((local.tm_hour * 60 + local.tm_min) * 60 + local.tm_sec) * 1000 + ts.tv_nsec / 1000000;
+}
+
+static speed_t baud_flag(long baud) {
+	switch(baud) {
+	case 2400:		return B2400;
+	case 4800:		return B4800;
+	case 9600:		return B9600;
+	case 19200:		return B19200;
+	case 38400:		return B38400;
+	case 57600:		return B57600;
+	case 115200:	return B115200;
+	default:
+		fprintf(stderr, "unsupported baud rate %ld\n", baud);
+		exit(2);
+	}
+}
+
+int main(int argc, char** argv) {
+	if(argc < 2) {
+		fprintf(stderr, "usage: %s port [baud]\n", argv[0]);
+		return 2;
+	}
+
+	int fd = open(argv[1], O_RDWR | O_NOCTTY);
+	if(fd < 0) {
+		perror(argv[1]);
+		return 2;
+	}
+
+	struct termios tio;
+	if(tcgetattr(fd, &tio) == 0) {
+		speed_t speed = baud_flag(argc > 2 ? atol(argv[2]) : 9600);
+		cfmakeraw(&tio);
+		cfsetispeed(&tio, speed);
+		cfsetospeed(&tio, speed);
+		tio.c_cc[VMIN] = 1;
+		tio.c_cc[VTIME] = 0;
+		tcsetattr(fd, TCSANOW, &tio);
+	}
+
+	const char* start = "\nsync on\n";
+	if(write(fd, start, strlen(start)) < 0) {
+		perror("write");
+		return 1;
+	}
+
+	uint8_t frame[255];
+	int n = 0;
+	bool in_frame = false;
+
+	uint8_t buf[64];
+	ssize_t got;
+	while((got = read(fd, buf, sizeof(buf))) > 0) {
+		// T2: as soon as the bytes are read
+		int32_t received = now_ms();
+
+		for(ssize_t k = 0; k < got; k++) {
+			uint8_t c = buf[k];
+
+			// Console text
+			if(!in_frame && c != 0) {
+				putchar(c);
+				if(c == '\n')
+					fflush(stdout);
+				continue;
+			}
+
+			// Binary frame: a zero opens it, the next zero closes it
+			if(c != 0) {
+				if(n < (int) sizeof(frame))
+					frame[n++] = c;
+				continue;
+			}
+			if(n == 0) {
+				in_frame = true;
+				continue;
+			}
+
+			uint8_t payload[256];
+			int m = n < (int) sizeof(frame) ? frame_decode(frame, n, payload) : -1;
+			n = 0;
+			in_frame = false;
+
+			if(m != (int) sizeof(t_sync_request) || payload[0] != SYNC_REQUEST)
+				continue;
+
+			t_sync_response response;
+			uint8_t out[sizeof(response) + 5];
+
+			response.type = SYNC_RESPONSE;
+			response.id = payload[1];
+			response.receive = received;
+			response.transmit = now_ms();	// T3, last thing before writing
+
+			uint8_t size = frame_encode((const uint8_t*) &response, sizeof(response), out);
+			if(write(fd, out, size) != size) {
+				perror("write");
+				return 1;
+			}
+		}
+	}
+
+	return 0;
+}